@@ -8,9 +8,16 @@
 #ifndef AFFIN_SHIFR_H
 #define AFFIN_SHIFR_H
 
-#include <cctype>  // Для tolower()
-#include <conio.h> // Для kbhit() и getch()
+#include "Cipher.h"
+#include "Console.h"
+#include "ContextCache.h"
+#include <array>
+#include <cctype> // Для tolower()
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <stdexcept>
 #include <string>
 
 using namespace std;
@@ -33,6 +40,123 @@ int mod_inv(int a, int m) {
   return 1;
 }
 
+/**
+ * @class AffineCipher
+ * @brief Аффинный шифр E(x) = (a*x + b) mod m над произвольным алфавитом
+ *
+ * Преобразование каждого байта заранее сводится в таблицы из 256 значений
+ * для шифрования и расшифрования, поэтому обработка текста - одна загрузка
+ * из таблицы на символ. Символы вне алфавита не изменяются.
+ */
+class AffineCipher : public CipherBase<AffineCipher> {
+  friend class CipherBase<AffineCipher>;
+
+  std::array<char, 256> encryptTable; ///< Байт открытого текста -> шифртекста
+  std::array<char, 256> decryptTable; ///< Байт шифртекста -> открытого текста
+  std::array<bool, 256> inAlphabet;   ///< Входит ли байт в алфавит
+
+  /**
+   * @brief Ядро шифра (см. CipherBase)
+   * @param input Вход
+   * @param output Выход (может совпадать с input)
+   * @param direction Направление
+   * @return Длина результата
+   */
+  size_t transformImpl(std::span<const char> input, std::span<char> output,
+                       Direction direction, size_t) const {
+    const std::array<char, 256> &table =
+        direction == Direction::Encrypt ? encryptTable : decryptTable;
+    for (size_t i = 0; i < input.size(); ++i) {
+      output[i] = table[static_cast<unsigned char>(input[i])];
+    }
+    return input.size();
+  }
+
+public:
+  static constexpr bool preservesLength = true; ///< Длина текста не меняется
+  static constexpr bool mapsBytes = true;       ///< Побайтовая замена
+
+  /**
+   * @brief Конструктор шифра
+   * @param alphabet Алфавит (символы не повторяются)
+   * @param a Мультипликативный ключ, взаимно простой с размером алфавита
+   * @param b Аддитивный ключ
+   * @throw std::invalid_argument Если алфавит пуст или содержит повторы либо
+   * a не взаимно прост с размером алфавита
+   */
+  AffineCipher(const std::string &alphabet, int a, int b) {
+    int m = alphabet.size();
+    if (m == 0) {
+      throw std::invalid_argument("Алфавит не может быть пустым");
+    }
+    a = (a % m + m) % m;
+    b = (b % m + m) % m;
+    if (std::gcd(a, m) != 1) {
+      throw std::invalid_argument(
+          "Ключ a должен быть взаимно простым с размером алфавита");
+    }
+    int inverse = mod_inv(a, m);
+    inAlphabet.fill(false);
+    for (int c = 0; c < 256; ++c) {
+      encryptTable[c] = decryptTable[c] = static_cast<char>(c);
+    }
+    for (int x = 0; x < m; ++x) {
+      unsigned char c = alphabet[x];
+      if (inAlphabet[c]) {
+        throw std::invalid_argument("Алфавит содержит повторяющиеся символы");
+      }
+      inAlphabet[c] = true;
+      encryptTable[c] = alphabet[(a * x + b) % m];
+      decryptTable[c] = alphabet[(x - b + m) % m * inverse % m];
+    }
+  }
+
+  /**
+   * @brief Входит ли символ в алфавит
+   * @param c Символ
+   * @return true, если символ шифруется
+   */
+  bool contains(char c) const {
+    return inAlphabet[static_cast<unsigned char>(c)];
+  }
+
+  /**
+   * @brief Шифрование на месте
+   * @param data Текст
+   */
+  void encryptInPlace(std::span<char> data) const {
+    transformInPlace(data, Direction::Encrypt);
+  }
+
+  /**
+   * @brief Расшифрование на месте
+   * @param data Шифртекст
+   */
+  void decryptInPlace(std::span<char> data) const {
+    transformInPlace(data, Direction::Decrypt);
+  }
+
+  /**
+   * @brief Шифрование строки
+   * @param plaintext Открытый текст
+   * @return Шифртекст
+   */
+  std::string encrypt(std::string plaintext) const {
+    encryptInPlace(plaintext);
+    return plaintext;
+  }
+
+  /**
+   * @brief Расшифрование строки
+   * @param ciphertext Шифртекст
+   * @return Открытый текст
+   */
+  std::string decrypt(std::string ciphertext) const {
+    decryptInPlace(ciphertext);
+    return ciphertext;
+  }
+};
+
 /**
  * @brief Основная функция для выполнения операций аффинного
  * шифрования/расшифрования
@@ -94,93 +218,70 @@ string main_Aff(string alphabet_vvod, string key_vvod, string text_vvod,
     int a = stoi(key.substr(0, pos)) % m;
     /** @brief Второй ключ аффинного шифра (аддитивный) */
     int b = stoi(key.substr(pos + 1)) % m;
+    /** @brief Шифр с введёнными алфавитом и ключами (из общего кэша) */
+    std::shared_ptr<const AffineCipher> cipher = cachedContext<AffineCipher>(
+        {"affine", alphabet, std::to_string(a), std::to_string(b)}, alphabet,
+        a, b);
 
     cout << "\nДля зашифрования нажмите -->" << endl;
     cout << "Для расшифрования нажмите <--" << endl;
 
     while (true) {
-      if (_kbhit() || mod != 0) {
-        /** @brief Код нажатой клавиши для выбора операции */
-        int arrow;
-        if (mod == 0) {
-          arrow = _getch();
+      /** @brief Код нажатой клавиши для выбора операции */
+      int arrow = mod == 0 ? readKey() : 0;
+      if (arrow == KeyEnd) {
+        break;
+      }
+      if (arrow == KeyRight || mod == 1) {
+        cout << "\nВведите открытый текст:" << endl;
+        /** @brief Открытый текст для шифрования */
+        string open_text;
+        if (text_vvod == "-1") {
+          getline(cin, open_text);
+        } else {
+          open_text = text_vvod;
         }
-        if (arrow == 77 || mod == 1) {
-          cout << "\nВведите открытый текст:" << endl;
-          /** @brief Открытый текст для шифрования */
-          string open_text;
-          if (text_vvod == "-1") {
-            getline(cin, open_text);
-          } else {
-            open_text = text_vvod;
-          }
-
-          for (auto &c : open_text) {
-            c = tolower(c);
-          }
-
-          /** @brief Результирующий зашифрованный текст */
-          string shifr_text = "";
-          for (size_t i = 0; i < open_text.length(); i++) {
-            /** @brief Индекс символа в алфавите */
-            size_t index = alphabet.find(open_text[i]);
-            if (index == string::npos) {
-              shifr_text += "";
-            } else {
-              /** @brief Индекс зашифрованного символа */
-              int shifr_ind = (a * index + b) % m;
-              shifr_text += alphabet[shifr_ind];
-            }
-          }
-
-          cout << "\nШифртекст:" << endl;
-          cout << shifr_text << endl;
-          return shifr_text;
-          break;
-        } else if (arrow == 75 || mod == 2) {
-          cout << "\nВведите шифртекст:" << endl;
-          /** @brief Зашифрованный текст для расшифрования */
-          string shifr_text;
-          if (text_vvod == "-1") {
-            getline(cin, shifr_text);
-          } else {
-            shifr_text = text_vvod;
-          }
-
-          for (auto &c : shifr_text) {
-            c = tolower(c);
-          }
-
-          /** @brief Результирующий расшифрованный текст */
-          string open_text = "";
-          /** @brief Модульная обратная величина ключа a */
-          int inv_a = mod_inv(a, m);
-
-          for (size_t i = 0; i < shifr_text.length(); i++) {
-            /** @brief Индекс зашифрованного символа в алфавите */
-            size_t index = alphabet.find(shifr_text[i]);
-            if (index == string::npos) {
-              open_text += "";
-            } else {
-              // Формула расшифрования: D(y) = ((y - b) * a^(-1)) mod m
-              /** @brief Индекс расшифрованного символа */
-              int open_ind = (index - b + m) % m;
-              open_ind = (open_ind * inv_a) % m;
-              open_text += alphabet[open_ind];
-            }
-          }
-
-          cout << "\nОткрытый текст:" << endl;
-          cout << open_text << endl;
-          return open_text;
-          break;
+
+        for (auto &c : open_text) {
+          c = tolower(c);
+        }
+
+        std::erase_if(open_text, [&](char c) { return !cipher->contains(c); });
+        /** @brief Результирующий зашифрованный текст */
+        string shifr_text = cipher->encrypt(open_text);
+
+        cout << "\nШифртекст:" << endl;
+        cout << shifr_text << endl;
+        return shifr_text;
+        break;
+      } else if (arrow == KeyLeft || mod == 2) {
+        cout << "\nВведите шифртекст:" << endl;
+        /** @brief Зашифрованный текст для расшифрования */
+        string shifr_text;
+        if (text_vvod == "-1") {
+          getline(cin, shifr_text);
+        } else {
+          shifr_text = text_vvod;
         }
+
+        for (auto &c : shifr_text) {
+          c = tolower(c);
+        }
+
+        std::erase_if(shifr_text, [&](char c) { return !cipher->contains(c); });
+        /** @brief Результирующий расшифрованный текст */
+        string open_text = cipher->decrypt(shifr_text);
+
+        cout << "\nОткрытый текст:" << endl;
+        cout << open_text << endl;
+        return open_text;
+        break;
       }
     }
   } catch (exception &e) {
     cout << "\nОшибка при проведении криптографической операции;" << endl;
     cout << "Проверьте корректность введенных данных." << endl;
   }
-  return 0;
+  return "";
 }
 #endif
\ No newline at end of file
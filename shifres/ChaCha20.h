@@ -0,0 +1,244 @@
+/**
+ * @file chacha20.h
+ * @brief Генератор гаммы ChaCha20 (RFC 8439) с произвольным доступом
+ * @details Гамма вычисляется блоками по 64 байта; блок с номером i зависит
+ *          только от ключа, nonce и i, поэтому гамму для любого смещения
+ *          можно получить без вычисления предыдущих блоков. При наличии AVX2
+ *          вычисляются сразу 8 блоков
+ */
+
+#ifndef CHACHA20_H
+#define CHACHA20_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CHACHA20_AVX2_KERNEL 1
+#endif
+
+/**
+ * @brief Циклический сдвиг 32-битного слова влево
+ * @param v Слово
+ * @param c Величина сдвига (от 1 до 31)
+ * @return Сдвинутое слово
+ */
+inline uint32_t chachaRotl(uint32_t v, int c) {
+  return (v << c) | (v >> (32 - c));
+}
+
+/**
+ * @brief Четвертной раунд ChaCha над четырьмя словами состояния
+ * @param x Состояние
+ * @param a Индекс первого слова
+ * @param b Индекс второго слова
+ * @param c Индекс третьего слова
+ * @param d Индекс четвёртого слова
+ */
+inline void chachaQuarterRound(uint32_t *x, int a, int b, int c, int d) {
+  x[a] += x[b];
+  x[d] = chachaRotl(x[d] ^ x[a], 16);
+  x[c] += x[d];
+  x[b] = chachaRotl(x[b] ^ x[c], 12);
+  x[a] += x[b];
+  x[d] = chachaRotl(x[d] ^ x[a], 8);
+  x[c] += x[d];
+  x[b] = chachaRotl(x[b] ^ x[c], 7);
+}
+
+/**
+ * @brief Блочная функция ChaCha20
+ * @param input Начальное состояние из 16 слов
+ * @param out 64 байта гаммы (слова в порядке little endian)
+ */
+inline void chacha20Block(const uint32_t *input, unsigned char *out) {
+  uint32_t x[16];
+  std::copy(input, input + 16, x);
+  for (int i = 0; i < 10; ++i) {
+    chachaQuarterRound(x, 0, 4, 8, 12);
+    chachaQuarterRound(x, 1, 5, 9, 13);
+    chachaQuarterRound(x, 2, 6, 10, 14);
+    chachaQuarterRound(x, 3, 7, 11, 15);
+    chachaQuarterRound(x, 0, 5, 10, 15);
+    chachaQuarterRound(x, 1, 6, 11, 12);
+    chachaQuarterRound(x, 2, 7, 8, 13);
+    chachaQuarterRound(x, 3, 4, 9, 14);
+  }
+  for (int i = 0; i < 16; ++i) {
+    uint32_t v = x[i] + input[i];
+    for (int j = 0; j < 4; ++j) {
+      out[4 * i + j] = static_cast<unsigned char>(v >> (8 * j));
+    }
+  }
+}
+
+#ifdef CHACHA20_AVX2_KERNEL
+/**
+ * @brief Проверка поддержки AVX2 процессором
+ * @return true, если можно вызывать 8-блочное ядро
+ */
+inline bool chachaCpuHasAvx2() {
+  static const bool has = __builtin_cpu_supports("avx2");
+  return has;
+}
+
+/**
+ * @brief Четвертной раунд ChaCha над восемью блоками одновременно
+ * @param x Состояние: по регистру на слово, по элементу на блок
+ * @param a Индекс первого слова
+ * @param b Индекс второго слова
+ * @param c Индекс третьего слова
+ * @param d Индекс четвёртого слова
+ * @param rot16 Перестановка байт для сдвига на 16
+ * @param rot8 Перестановка байт для сдвига на 8
+ */
+__attribute__((target("avx2"))) inline void
+chachaQuarterRoundAvx2(__m256i *x, int a, int b, int c, int d, __m256i rot16,
+                       __m256i rot8) {
+  x[a] = _mm256_add_epi32(x[a], x[b]);
+  x[d] = _mm256_shuffle_epi8(_mm256_xor_si256(x[d], x[a]), rot16);
+  x[c] = _mm256_add_epi32(x[c], x[d]);
+  __m256i t = _mm256_xor_si256(x[b], x[c]);
+  x[b] = _mm256_or_si256(_mm256_slli_epi32(t, 12), _mm256_srli_epi32(t, 20));
+  x[a] = _mm256_add_epi32(x[a], x[b]);
+  x[d] = _mm256_shuffle_epi8(_mm256_xor_si256(x[d], x[a]), rot8);
+  x[c] = _mm256_add_epi32(x[c], x[d]);
+  t = _mm256_xor_si256(x[b], x[c]);
+  x[b] = _mm256_or_si256(_mm256_slli_epi32(t, 7), _mm256_srli_epi32(t, 25));
+}
+
+/**
+ * @brief Вычисление восьми последовательных блоков ChaCha20 в AVX2
+ * @param input Начальное состояние первого блока (счётчик в слове 12)
+ * @param out 512 байт гаммы
+ * @details Каждое слово состояния хранится в отдельном регистре, восемь
+ *          элементов регистра - восемь блоков со счётчиками counter..counter+7.
+ *          Сдвиги на 16 и 8 выполняются перестановкой байт
+ */
+__attribute__((target("avx2"))) inline void
+chacha20Block8Avx2(const uint32_t *input, unsigned char *out) {
+  const __m256i rot16 = _mm256_setr_epi8(
+      2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3, 0, 1, 6, 7,
+      4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+  const __m256i rot8 = _mm256_setr_epi8(
+      3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14, 3, 0, 1, 2, 7, 4,
+      5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+  __m256i start[16], x[16];
+  for (int i = 0; i < 16; ++i) {
+    start[i] = _mm256_set1_epi32(static_cast<int>(input[i]));
+  }
+  start[12] =
+      _mm256_add_epi32(start[12], _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  std::copy(start, start + 16, x);
+
+  for (int i = 0; i < 10; ++i) {
+    chachaQuarterRoundAvx2(x, 0, 4, 8, 12, rot16, rot8);
+    chachaQuarterRoundAvx2(x, 1, 5, 9, 13, rot16, rot8);
+    chachaQuarterRoundAvx2(x, 2, 6, 10, 14, rot16, rot8);
+    chachaQuarterRoundAvx2(x, 3, 7, 11, 15, rot16, rot8);
+    chachaQuarterRoundAvx2(x, 0, 5, 10, 15, rot16, rot8);
+    chachaQuarterRoundAvx2(x, 1, 6, 11, 12, rot16, rot8);
+    chachaQuarterRoundAvx2(x, 2, 7, 8, 13, rot16, rot8);
+    chachaQuarterRoundAvx2(x, 3, 4, 9, 14, rot16, rot8);
+  }
+
+  alignas(32) uint32_t words[16][8];
+  for (int i = 0; i < 16; ++i) {
+    _mm256_store_si256(reinterpret_cast<__m256i *>(words[i]),
+                       _mm256_add_epi32(x[i], start[i]));
+  }
+  for (int block = 0; block < 8; ++block) {
+    for (int i = 0; i < 16; ++i) {
+      uint32_t v = words[i][block];
+      std::memcpy(out + block * 64 + i * 4, &v, 4); // x86 - little endian
+    }
+  }
+}
+#endif
+
+/**
+ * @class ChaCha20
+ * @brief Генератор гаммы ChaCha20 с доступом к любому смещению
+ */
+class ChaCha20 {
+  uint32_t state[16]; ///< Константы, ключ, счётчик (слово 12) и nonce
+
+public:
+  /// Максимальная длина гаммы: 2^32 блоков по 64 байта
+  static constexpr uint64_t maxStreamLength = uint64_t(1) << 38;
+
+  /**
+   * @brief Конструктор генератора
+   * @param key 32 байта ключа
+   * @param nonce 12 байт nonce (разные сообщения с одним ключом должны
+   * использовать разные nonce)
+   */
+  ChaCha20(const unsigned char *key, const unsigned char *nonce) {
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    auto word = [](const unsigned char *p) {
+      return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 |
+             uint32_t(p[3]) << 24;
+    };
+    for (int i = 0; i < 8; ++i) {
+      state[4 + i] = word(key + 4 * i);
+    }
+    state[12] = 0;
+    for (int i = 0; i < 3; ++i) {
+      state[13 + i] = word(nonce + 4 * i);
+    }
+  }
+
+  /**
+   * @brief Вычисление гаммы начиная с произвольного смещения
+   * @param offset Смещение первого байта в гамме
+   * @param out Буфер для гаммы
+   * @param size Число байт
+   * @throw std::out_of_range Если запрошенный участок выходит за пределы
+   * 2^32 блоков
+   */
+  void keystream(uint64_t offset, unsigned char *out, size_t size) const {
+    if (offset > maxStreamLength || size > maxStreamLength - offset) {
+      throw std::out_of_range("Смещение за пределами гаммы ChaCha20");
+    }
+    uint32_t input[16];
+    std::copy(state, state + 16, input);
+    uint64_t block = offset / 64;
+    size_t skip = offset % 64;
+    unsigned char buffer[64];
+
+    while (size > 0) {
+      input[12] = static_cast<uint32_t>(block);
+#ifdef CHACHA20_AVX2_KERNEL
+      if (skip == 0 && size >= 512 && chachaCpuHasAvx2() &&
+          block + 8 <= (uint64_t(1) << 32)) {
+        chacha20Block8Avx2(input, out);
+        out += 512;
+        size -= 512;
+        block += 8;
+        continue;
+      }
+#endif
+      if (skip == 0 && size >= 64) {
+        chacha20Block(input, out);
+        out += 64;
+        size -= 64;
+      } else {
+        chacha20Block(input, buffer);
+        size_t len = std::min<size_t>(64 - skip, size);
+        std::copy(buffer + skip, buffer + skip + len, out);
+        out += len;
+        size -= len;
+        skip = 0;
+      }
+      ++block;
+    }
+  }
+};
+
+#endif // CHACHA20_H
@@ -0,0 +1,269 @@
+/**
+ * @file cipher.h
+ * @brief Общий интерфейс шифров: transform(вход, выход, направление)
+ * @details Каждый шифр наследует CipherBase<Шифр> (CRTP) и реализует одно
+ *          ядро transformImpl. Общие операции - обработка строк, на месте,
+ *          параллельная обработка больших буферов - написаны один раз в
+ *          CipherBase и вызывают ядро без виртуальных вызовов, так что оно
+ *          встраивается во внутренние циклы. Для выбора шифра во время
+ *          выполнения служит интерфейс Cipher с виртуальными методами и
+ *          обёртка CipherAdapter: виртуальный вызов приходится на буфер, а
+ *          не на символ
+ */
+
+#ifndef CIPHER_H
+#define CIPHER_H
+
+#include "ThreadPool.h"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief Направление преобразования
+ */
+enum class Direction {
+  Encrypt, ///< Шифрование
+  Decrypt  ///< Расшифрование
+};
+
+/// Буферы короче этого размера transformParallel обрабатывает в вызывающем
+/// потоке
+constexpr size_t cipherParallelMinSize = size_t(1) << 20;
+/// Граница участков параллельной обработки
+constexpr size_t cipherParallelGrain = 4096;
+
+/**
+ * @class CipherBase
+ * @brief Общие операции шифра поверх ядра наследника (CRTP)
+ * @tparam Derived Шифр, который должен определить:
+ *         - static constexpr bool preservesLength - сохраняет ли шифр длину
+ *           текста (тогда выход i-го символа зависит только от него и его
+ *           позиции offset + i);
+ *         - size_t transformImpl(std::span<const char> input,
+ *           std::span<char> output, Direction direction, size_t offset) const
+ *           - ядро; возвращает длину результата;
+ *         - size_t maxOutputImpl(size_t inputSize, Direction direction) const
+ *           - только если preservesLength == false
+ *         Шифр, заменяющий каждый байт независимо от позиции, может объявить
+ *         static constexpr bool mapsBytes = true (см. CipherPipeline)
+ */
+template <class Derived> class CipherBase {
+  /**
+   * @brief Доступ к наследнику
+   * @return Шифр
+   */
+  const Derived &self() const { return static_cast<const Derived &>(*this); }
+
+public:
+  /**
+   * @brief Наибольшая длина результата
+   * @param inputSize Длина входа
+   * @param direction Направление
+   * @return Размер выходного буфера, достаточный для transform
+   */
+  size_t maxOutput(size_t inputSize, Direction direction) const {
+    if constexpr (Derived::preservesLength) {
+      (void)direction;
+      return inputSize;
+    } else {
+      return self().maxOutputImpl(inputSize, direction);
+    }
+  }
+
+  /**
+   * @brief Преобразование буфера
+   * @param input Вход
+   * @param output Выход не короче maxOutput(input.size(), direction); для
+   * шифров, сохраняющих длину, может совпадать с input
+   * @param direction Направление
+   * @param offset Позиция input[0] в потоке (для шифров с ключом,
+   * зависящим от позиции; остальные шифры её не используют)
+   * @return Длина результата
+   * @throw std::invalid_argument Если выходной буфер мал или вход не
+   * подходит шифру
+   */
+  size_t transform(std::span<const char> input, std::span<char> output,
+                   Direction direction, size_t offset = 0) const {
+    if (output.size() < maxOutput(input.size(), direction)) {
+      throw std::invalid_argument("Выходной буфер слишком мал");
+    }
+    return self().transformImpl(input, output, direction, offset);
+  }
+
+  /**
+   * @brief Преобразование строки
+   * @param input Вход
+   * @param direction Направление
+   * @return Результат
+   */
+  std::string transform(std::string_view input, Direction direction) const {
+    std::string output(maxOutput(input.size(), direction), '\0');
+    output.resize(self().transformImpl(input, output, direction, 0));
+    return output;
+  }
+
+  /**
+   * @brief Преобразование на месте (для шифров, сохраняющих длину)
+   * @param data Текст
+   * @param direction Направление
+   * @param offset Позиция data[0] в потоке
+   */
+  void transformInPlace(std::span<char> data, Direction direction,
+                        size_t offset = 0) const {
+    static_assert(Derived::preservesLength,
+                  "transformInPlace требует шифра, сохраняющего длину");
+    self().transformImpl(data, data, direction, offset);
+  }
+
+  /**
+   * @brief Параллельное преобразование большого буфера (для шифров,
+   * сохраняющих длину)
+   * @param input Вход
+   * @param output Выход не короче input (может совпадать с ним)
+   * @param direction Направление
+   * @param offset Позиция input[0] в потоке
+   * @param pool Пул потоков
+   * @throw std::invalid_argument Если выходной буфер короче входного или
+   * вход не подходит шифру
+   * @details Буфер делится статически на непрерывные участки по числу
+   *          потоков с границами, кратными cipherParallelGrain; участок с
+   *          началом b обрабатывается ядром со смещением offset + b, поэтому
+   *          результат совпадает с transform
+   */
+  void transformParallel(std::span<const char> input, std::span<char> output,
+                         Direction direction, size_t offset = 0,
+                         ThreadPool &pool = ThreadPool::shared()) const {
+    static_assert(Derived::preservesLength,
+                  "transformParallel требует шифра, сохраняющего длину");
+    if (output.size() < input.size()) {
+      throw std::invalid_argument("Выходной буфер слишком мал");
+    }
+    if (input.size() < cipherParallelMinSize || pool.size() == 1) {
+      self().transformImpl(input, output, direction, offset);
+      return;
+    }
+    pool.parallelFor(input.size(), cipherParallelGrain,
+                     [&](size_t begin, size_t end) {
+                       self().transformImpl(input.subspan(begin, end - begin),
+                                            output.subspan(begin), direction,
+                                            offset + begin);
+                     });
+  }
+};
+
+/**
+ * @class Cipher
+ * @brief Шифр, выбираемый во время выполнения
+ *
+ * Виртуальные методы работают с целыми буферами; внутри них ядро шифра
+ * вызывается статически (см. CipherAdapter).
+ */
+class Cipher {
+public:
+  virtual ~Cipher() = default;
+
+  /**
+   * @brief Сохраняет ли шифр длину текста
+   * @return true, если доступна параллельная обработка
+   */
+  virtual bool preservesLength() const = 0;
+
+  /**
+   * @brief Наибольшая длина результата
+   * @param inputSize Длина входа
+   * @param direction Направление
+   * @return Размер выходного буфера, достаточный для transform
+   */
+  virtual size_t maxOutput(size_t inputSize, Direction direction) const = 0;
+
+  /**
+   * @brief Преобразование буфера (см. CipherBase::transform)
+   * @param input Вход
+   * @param output Выход не короче maxOutput(input.size(), direction)
+   * @param direction Направление
+   * @param offset Позиция input[0] в потоке
+   * @return Длина результата
+   */
+  virtual size_t transform(std::span<const char> input,
+                           std::span<char> output, Direction direction,
+                           size_t offset) const = 0;
+
+  /**
+   * @brief Параллельное преобразование (см. CipherBase::transformParallel)
+   * @param input Вход
+   * @param output Выход не короче input
+   * @param direction Направление
+   * @param offset Позиция input[0] в потоке
+   * @param pool Пул потоков
+   * @throw std::invalid_argument Если шифр не сохраняет длину текста
+   */
+  virtual void transformParallel(std::span<const char> input,
+                                 std::span<char> output, Direction direction,
+                                 size_t offset, ThreadPool &pool) const = 0;
+
+  /**
+   * @brief Преобразование строки
+   * @param input Вход
+   * @param direction Направление
+   * @return Результат
+   */
+  std::string transform(std::string_view input, Direction direction) const {
+    std::string output(maxOutput(input.size(), direction), '\0');
+    output.resize(transform(input, output, direction, 0));
+    return output;
+  }
+};
+
+/**
+ * @class CipherAdapter
+ * @brief Реализация Cipher для шифра с CipherBase
+ * @tparam Impl Шифр
+ */
+template <class Impl> class CipherAdapter final : public Cipher {
+  std::shared_ptr<const Impl> impl; ///< Шифр (может разделяться)
+
+public:
+  using Cipher::transform;
+
+  /**
+   * @brief Обёртка над готовым шифром
+   * @param cipher Шифр
+   */
+  explicit CipherAdapter(std::shared_ptr<const Impl> cipher)
+      : impl(std::move(cipher)) {}
+
+  /**
+   * @brief Обёрнутый шифр
+   * @return Шифр
+   */
+  const Impl &get() const { return *impl; }
+
+  bool preservesLength() const override { return Impl::preservesLength; }
+
+  size_t maxOutput(size_t inputSize, Direction direction) const override {
+    return impl->maxOutput(inputSize, direction);
+  }
+
+  size_t transform(std::span<const char> input, std::span<char> output,
+                   Direction direction, size_t offset) const override {
+    return impl->transform(input, output, direction, offset);
+  }
+
+  void transformParallel(std::span<const char> input, std::span<char> output,
+                         Direction direction, size_t offset,
+                         ThreadPool &pool) const override {
+    if constexpr (Impl::preservesLength) {
+      impl->transformParallel(input, output, direction, offset, pool);
+    } else {
+      throw std::invalid_argument(
+          "Параллельная обработка требует шифра, сохраняющего длину");
+    }
+  }
+};
+
+#endif // CIPHER_H
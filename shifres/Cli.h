@@ -0,0 +1,605 @@
+/**
+ * @file cli.h
+ * @brief Неинтерактивный запуск шифров с параметрами из командной строки
+ * @details Шифр и ключ задаются флагами, например
+ *          `shifres --cipher vigenere --key rus --decrypt -i in -o out`.
+ *          Контекст шифра строится один раз, после чего вход читается
+ *          частями по 1 МБ и проходит через шифр потоком. Никаких правил и
+ *          приглашений не выводится: в выходной поток попадает только
+ *          результат, ошибки пишутся в поток ошибок
+ */
+
+#ifndef CLI_H
+#define CLI_H
+
+#include "Affin_Shifr.h"
+#include "Cipher.h"
+#include "ContextCache.h"
+#include "Filter.h"
+#include "Hill.h"
+#include "RSA.h"
+#include "Simple_sub.h"
+#include "Vernam.h"
+#include "Vij.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Ошибка в параметрах командной строки
+ */
+class CliUsageError : public std::invalid_argument {
+public:
+  using std::invalid_argument::invalid_argument;
+};
+
+/**
+ * @struct CliOptions
+ * @brief Параметры запуска из командной строки
+ */
+struct CliOptions {
+  std::string cipher;                                  ///< Название шифра
+  std::string key;                                     ///< Ключ
+  std::string alphabet = "abcdefghijklmnopqrstuvwxyz"; ///< Алфавит
+  bool decrypt = false;                                ///< Расшифрование
+  std::string input = "-";                             ///< Входной файл
+  std::string output = "-";                            ///< Выходной файл
+  bool help = false;                                   ///< Вывести справку
+};
+
+/// Справка по параметрам командной строки
+inline constexpr const char *cliUsage =
+    "Использование: shifres -c ШИФР -k КЛЮЧ [-a АЛФАВИТ] [-e|-d] [-i ВХОД] "
+    "[-o ВЫХОД]\n"
+    "  -c, --cipher    affine | vigenere | rsa | subst | hill | vernam\n"
+    "  -k, --key       ключ: affine - \"a b\", vigenere - слово из алфавита,\n"
+    "                  rsa - \"p q e\", subst - 26 букв, hill - n*n чисел\n"
+    "                  матрицы по строкам, vernam - строка\n"
+    "  -a, --alphabet  алфавит для affine, vigenere и hill (по умолчанию a-z)\n"
+    "  -e, --encrypt   шифрование (по умолчанию)\n"
+    "  -d, --decrypt   расшифрование\n"
+    "  -i, --input     входной файл (по умолчанию стандартный ввод)\n"
+    "  -o, --output    выходной файл (по умолчанию стандартный вывод)\n"
+    "  -h, --help      эта справка\n";
+
+/**
+ * @brief Разбор параметров командной строки
+ * @param argc Число аргументов
+ * @param argv Аргументы (argv[0] - имя программы)
+ * @return Параметры запуска
+ * @throw CliUsageError Если флаг неизвестен, у флага нет значения, шифр не
+ * указан или неизвестен либо не задан ключ
+ */
+inline CliOptions parseCliOptions(int argc, const char *const *argv) {
+  CliOptions options;
+  for (int i = 1; i < argc; ++i) {
+    std::string flag = argv[i];
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw CliUsageError("У параметра " + flag + " нет значения");
+      }
+      return argv[++i];
+    };
+    if (flag == "-c" || flag == "--cipher") {
+      options.cipher = value();
+    } else if (flag == "-k" || flag == "--key") {
+      options.key = value();
+    } else if (flag == "-a" || flag == "--alphabet") {
+      options.alphabet = value();
+    } else if (flag == "-e" || flag == "--encrypt") {
+      options.decrypt = false;
+    } else if (flag == "-d" || flag == "--decrypt") {
+      options.decrypt = true;
+    } else if (flag == "-i" || flag == "--input") {
+      options.input = value();
+    } else if (flag == "-o" || flag == "--output") {
+      options.output = value();
+    } else if (flag == "-h" || flag == "--help") {
+      options.help = true;
+    } else {
+      throw CliUsageError("Неизвестный параметр " + flag);
+    }
+  }
+  if (options.help) {
+    return options;
+  }
+  static const char *const ciphers[] = {"affine", "vigenere", "rsa",
+                                        "subst",  "hill",     "vernam"};
+  if (std::find(std::begin(ciphers), std::end(ciphers), options.cipher) ==
+      std::end(ciphers)) {
+    throw CliUsageError(options.cipher.empty()
+                            ? "Не указан шифр"
+                            : "Неизвестный шифр " + options.cipher);
+  }
+  if (options.key.empty()) {
+    throw CliUsageError("Не указан ключ");
+  }
+  return options;
+}
+
+/**
+ * @class CliStream
+ * @brief Шифр, обрабатывающий вход частями произвольной длины
+ */
+class CliStream {
+public:
+  virtual ~CliStream() = default;
+
+  /**
+   * @brief Обработка очередной части входа
+   * @param chunk Часть входа; может изменяться на месте
+   * @param out Поток для результата
+   */
+  virtual void update(std::span<char> chunk, std::ostream &out) = 0;
+
+  /**
+   * @brief Завершение обработки после последней части
+   * @param out Поток для результата
+   */
+  virtual void finish(std::ostream &out) { (void)out; }
+};
+
+/**
+ * @class CliByteStream
+ * @brief Шифр, переводящий каждую часть входа в часть той же длины
+ *
+ * Такие шифры работают и в режиме фильтра (см. runCliFilter): части
+ * преобразуются на месте прямо в буфере чтения.
+ */
+class CliByteStream : public CliStream {
+public:
+  /**
+   * @brief Преобразование очередной части входа на месте
+   * @param chunk Часть входа
+   */
+  virtual void transform(std::span<char> chunk) = 0;
+
+  void update(std::span<char> chunk, std::ostream &out) override {
+    transform(chunk);
+    out.write(chunk.data(), chunk.size());
+  }
+};
+
+/**
+ * @class CliCipherStream
+ * @brief Поток для шифра, сохраняющего длину, по общему интерфейсу
+ * @tparam Impl Шифр с CipherBase (аффинный, простая замена, Вернам)
+ */
+template <class Impl> class CliCipherStream : public CliByteStream {
+  std::shared_ptr<const Impl> cipher; ///< Шифр
+  Direction direction;                ///< Направление
+  size_t offset = 0;                  ///< Позиция следующего байта в потоке
+
+public:
+  CliCipherStream(std::shared_ptr<const Impl> c, bool decrypt)
+      : cipher(std::move(c)),
+        direction(decrypt ? Direction::Decrypt : Direction::Encrypt) {}
+
+  void transform(std::span<char> chunk) override {
+    cipher->transformInPlace(chunk, direction, offset);
+    offset += chunk.size();
+  }
+};
+
+/**
+ * @class CliVigenereStream
+ * @brief Поток шифра Виженера: символы вне алфавита (пробелы, переводы
+ * строк) выводятся без изменений и не сдвигают ключ
+ */
+class CliVigenereStream : public CliByteStream {
+  std::shared_ptr<const VigenereCipher> cipher; ///< Шифр
+  Direction direction;                          ///< Направление
+  size_t offset = 0; ///< Число обработанных символов алфавита
+
+public:
+  CliVigenereStream(std::shared_ptr<const VigenereCipher> c, bool decrypt)
+      : cipher(std::move(c)),
+        direction(decrypt ? Direction::Decrypt : Direction::Encrypt) {}
+
+  void transform(std::span<char> chunk) override {
+    offset = cipher->transformLetters(chunk, direction, offset);
+  }
+};
+
+/**
+ * @class CliHillStream
+ * @brief Поток шифра Хилла: символы вне алфавита отбрасываются, последний
+ * блок при шифровании дополняется символом дополнения
+ */
+class CliHillStream : public CliStream {
+  std::shared_ptr<const HillCipher> cipher; ///< Шифр (объявлен до stream)
+  HillStream stream; ///< Перенос неполных блоков между частями
+
+public:
+  CliHillStream(std::shared_ptr<const HillCipher> c, bool decrypt)
+      : cipher(std::move(c)), stream(*cipher, decrypt) {}
+
+  void update(std::span<char> chunk, std::ostream &out) override {
+    size_t length = cipher->normalizeInPlace(chunk);
+    stream.update(chunk.first(length), [&](std::span<char> part) {
+      out.write(part.data(), part.size());
+    });
+  }
+
+  void finish(std::ostream &out) override {
+    stream.finish([&](std::span<char> part) {
+      out.write(part.data(), part.size());
+    });
+  }
+};
+
+/**
+ * @class CliRsaStream
+ * @brief Поток RSA: вход - целые числа через пробельные символы, выход -
+ * результаты по одному в строке
+ */
+class CliRsaStream : public CliStream {
+  RsaKey key;        ///< Ключи
+  bool decrypting;   ///< true - расшифрование
+  std::string token; ///< Число, разрезанное границей частей
+
+  /**
+   * @brief Обработка накопленного числа
+   * @param out Поток для результата
+   * @throw std::invalid_argument Если число не меньше модуля
+   */
+  void flush(std::ostream &out) {
+    if (token.empty()) {
+      return;
+    }
+    long long value = token.size() > 18 ? key.n : std::stoll(token);
+    if (value >= key.n) {
+      throw std::invalid_argument("Число " + token + " не меньше модуля n");
+    }
+    token.clear();
+    out << (decrypting ? key.decrypt(value) : key.encrypt(value)) << '\n';
+  }
+
+public:
+  CliRsaStream(RsaKey k, bool decrypt) : key(k), decrypting(decrypt) {}
+
+  void update(std::span<char> chunk, std::ostream &out) override {
+    for (char c : chunk) {
+      if (isdigit(static_cast<unsigned char>(c))) {
+        token += c;
+      } else if (isspace(static_cast<unsigned char>(c))) {
+        flush(out);
+      } else {
+        throw std::invalid_argument(std::string("Недопустимый символ '") + c +
+                                    "' во входных числах");
+      }
+    }
+  }
+
+  void finish(std::ostream &out) override { flush(out); }
+};
+
+/**
+ * @brief Разбор ключа из целых чисел через пробел
+ * @param key Строка ключа
+ * @param count Ожидаемое число чисел (0 - любое ненулевое)
+ * @return Числа ключа
+ * @throw std::invalid_argument Если ключ содержит не числа или их число не
+ * совпадает с ожидаемым
+ */
+inline std::vector<long long> parseCliNumbers(const std::string &key,
+                                              size_t count) {
+  std::istringstream stream(key);
+  std::vector<long long> numbers;
+  long long number;
+  while (stream >> number) {
+    numbers.push_back(number);
+  }
+  if (!stream.eof() || numbers.empty() ||
+      (count != 0 && numbers.size() != count)) {
+    throw std::invalid_argument("Некорректный ключ: " + key);
+  }
+  return numbers;
+}
+
+/**
+ * @brief Разбор ключа из чисел типа int (аффинный шифр, матрица Хилла)
+ * @param key Строка ключа
+ * @param count Ожидаемое число чисел (0 - любое ненулевое)
+ * @return Числа ключа
+ * @throw std::invalid_argument Если ключ содержит не числа или их число не
+ * совпадает с ожидаемым
+ * @throw CliUsageError Если число не помещается в int (иначе оно молча
+ * усекалось бы до другого ключа)
+ */
+inline std::vector<int> parseCliInts(const std::string &key, size_t count) {
+  std::vector<int> numbers;
+  for (long long number : parseCliNumbers(key, count)) {
+    if (number < std::numeric_limits<int>::min() ||
+        number > std::numeric_limits<int>::max()) {
+      throw CliUsageError("Число ключа вне допустимого диапазона: " +
+                          std::to_string(number));
+    }
+    numbers.push_back(static_cast<int>(number));
+  }
+  return numbers;
+}
+
+/**
+ * @class CliContext
+ * @brief Подготовленный шифр, из которого создаются независимые потоки
+ *
+ * Таблицы, ключевые матрицы и экспоненты строятся один раз в конструкторе и
+ * разделяются всеми потоками, созданными open(); у каждого потока своё
+ * состояние (фаза ключа, перенос неполного блока). Контекст неизменяем,
+ * поэтому потоки можно создавать и использовать из разных нитей.
+ */
+class CliContext {
+  /// Создание потока для шифров, сохраняющих длину (иначе пусто)
+  std::function<std::unique_ptr<CliByteStream>(bool)> openBytesFn;
+  /// Создание потока для RSA и шифра Хилла (иначе пусто)
+  std::function<std::unique_ptr<CliStream>(bool)> openStreamFn;
+  /// Тот же шифр за общим интерфейсом
+  std::shared_ptr<const Cipher> unified;
+
+public:
+  /**
+   * @brief Подготовка шифра по параметрам запуска
+   * @param options Параметры (направление и файлы не используются)
+   * @throw std::invalid_argument Если шифр неизвестен либо ключ или алфавит
+   * не подходят шифру
+   * @throw std::runtime_error Если матрица Хилла необратима
+   */
+  explicit CliContext(const CliOptions &options) {
+    const std::string &name = options.cipher;
+    if (name == "affine") {
+      std::vector<int> ab = parseCliInts(options.key, 2);
+      auto cipher = std::make_shared<const AffineCipher>(options.alphabet,
+                                                         ab[0], ab[1]);
+      openBytesFn = [cipher](bool decrypt) {
+        return std::make_unique<CliCipherStream<AffineCipher>>(cipher,
+                                                               decrypt);
+      };
+      unified = std::make_shared<const CipherAdapter<AffineCipher>>(cipher);
+    } else if (name == "vigenere") {
+      auto cipher =
+          std::make_shared<const VigenereCipher>(options.alphabet, options.key);
+      openBytesFn = [cipher](bool decrypt) {
+        return std::make_unique<CliVigenereStream>(cipher, decrypt);
+      };
+      unified = std::make_shared<const CipherAdapter<VigenereCipher>>(cipher);
+    } else if (name == "subst") {
+      auto cipher = std::make_shared<const SimpleSubstitution>(options.key);
+      openBytesFn = [cipher](bool decrypt) {
+        return std::make_unique<CliCipherStream<SimpleSubstitution>>(
+            cipher, decrypt);
+      };
+      unified =
+          std::make_shared<const CipherAdapter<SimpleSubstitution>>(cipher);
+    } else if (name == "vernam") {
+      auto cipher = std::make_shared<const VernamCipher>(options.key);
+      openBytesFn = [cipher](bool decrypt) {
+        return std::make_unique<CliCipherStream<VernamCipher>>(cipher,
+                                                               decrypt);
+      };
+      unified = std::make_shared<const CipherAdapter<VernamCipher>>(cipher);
+    } else if (name == "rsa") {
+      std::vector<long long> pqe = parseCliNumbers(options.key, 3);
+      auto key = std::make_shared<const RsaKey>(pqe[0], pqe[1], pqe[2]);
+      openStreamFn = [key](bool decrypt) {
+        return std::make_unique<CliRsaStream>(*key, decrypt);
+      };
+      unified = std::make_shared<const CipherAdapter<RsaKey>>(key);
+    } else if (name == "hill") {
+      std::vector<int> numbers = parseCliInts(options.key, 0);
+      size_t n = 1;
+      while (n * n < numbers.size()) {
+        ++n;
+      }
+      if (n * n != numbers.size()) {
+        throw std::invalid_argument(
+            "Число элементов матрицы Хилла должно быть квадратом");
+      }
+      std::vector<std::vector<int>> matrix(n, std::vector<int>(n));
+      for (size_t i = 0; i < numbers.size(); ++i) {
+        matrix[i / n][i % n] = numbers[i];
+      }
+      auto cipher =
+          std::make_shared<const HillCipher>(matrix, options.alphabet);
+      openStreamFn = [cipher](bool decrypt) {
+        return std::make_unique<CliHillStream>(cipher, decrypt);
+      };
+      unified = std::make_shared<const CipherAdapter<HillCipher>>(cipher);
+    } else {
+      throw std::invalid_argument("Неизвестный шифр " + name);
+    }
+  }
+
+  /**
+   * @brief Сохраняет ли шифр длину текста
+   * @return true для аффинного шифра, Виженера, простой замены и Вернама
+   */
+  bool preservesLength() const { return static_cast<bool>(openBytesFn); }
+
+  /**
+   * @brief Шифр за общим интерфейсом (см. Cipher)
+   * @return Шифр, разделяемый с потоками контекста
+   */
+  const Cipher &cipher() const { return *unified; }
+
+  /**
+   * @brief Новый поток шифра
+   * @param decrypt true - расшифрование
+   * @return Поток с собственным состоянием
+   */
+  std::unique_ptr<CliStream> open(bool decrypt) const {
+    if (openBytesFn) {
+      return openBytesFn(decrypt);
+    }
+    return openStreamFn(decrypt);
+  }
+
+  /**
+   * @brief Новый поток шифра, сохраняющего длину
+   * @param decrypt true - расшифрование
+   * @return Поток или nullptr для RSA и шифра Хилла
+   */
+  std::unique_ptr<CliByteStream> openBytes(bool decrypt) const {
+    return openBytesFn ? openBytesFn(decrypt) : nullptr;
+  }
+
+  /**
+   * @brief Контекст из общего кэша процесса
+   * @param options Параметры (используются шифр, ключ и алфавит)
+   * @return Общий контекст; подготавливается только при первом запросе
+   * @throw Те же исключения, что и конструктор
+   */
+  static std::shared_ptr<const CliContext> cached(const CliOptions &options) {
+    return cachedContext<CliContext>(
+        {options.cipher, options.alphabet, options.key}, options);
+  }
+};
+
+/**
+ * @brief Неинтерактивный запуск шифра
+ * @param argc Число аргументов
+ * @param argv Аргументы командной строки
+ * @param in Вход, если входной файл не указан
+ * @param out Выход, если выходной файл не указан
+ * @param err Поток для сообщений об ошибках
+ * @return 0 при успехе, 2 при ошибке в параметрах, 1 при прочих ошибках
+ */
+inline int runCli(int argc, const char *const *argv, std::istream &in,
+                  std::ostream &out, std::ostream &err) {
+  constexpr size_t bufferSize = size_t(1) << 20;
+  CliOptions options;
+  try {
+    options = parseCliOptions(argc, argv);
+  } catch (const CliUsageError &e) {
+    err << "shifres: " << e.what() << '\n' << cliUsage;
+    return 2;
+  }
+  if (options.help) {
+    out << cliUsage;
+    return 0;
+  }
+
+  try {
+    std::unique_ptr<CliStream> stream =
+        CliContext::cached(options)->open(options.decrypt);
+    std::ifstream inputFile;
+    std::istream *source = &in;
+    if (options.input != "-") {
+      inputFile.open(options.input, std::ios::binary);
+      if (!inputFile) {
+        throw std::runtime_error("Не удалось открыть файл " + options.input);
+      }
+      source = &inputFile;
+    }
+    std::ofstream outputFile;
+    std::ostream *sink = &out;
+    if (options.output != "-") {
+      outputFile.open(options.output, std::ios::binary | std::ios::trunc);
+      if (!outputFile) {
+        throw std::runtime_error("Не удалось создать файл " + options.output);
+      }
+      sink = &outputFile;
+    }
+
+    std::vector<char> buffer(bufferSize);
+    while (source->read(buffer.data(), buffer.size()) ||
+           source->gcount() > 0) {
+      stream->update(std::span<char>(buffer.data(), source->gcount()), *sink);
+    }
+    if (source->bad()) {
+      throw std::runtime_error("Ошибка чтения входных данных");
+    }
+    stream->finish(*sink);
+    if (!sink->flush()) {
+      throw std::runtime_error("Ошибка записи результата");
+    }
+  } catch (const CliUsageError &e) {
+    err << "shifres: " << e.what() << '\n' << cliUsage;
+    return 2;
+  } catch (const std::exception &e) {
+    err << "shifres: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Можно ли выполнить запуск в режиме фильтра
+ * @param argc Число аргументов
+ * @param argv Аргументы командной строки
+ * @return true, если параметры корректны и шифр сохраняет длину текста
+ * (аффинный, Виженера, простой замены, Вернама)
+ * @details Ошибки в параметрах здесь не сообщаются: такие запуски передаются
+ *          runCli, который выводит ошибку и справку
+ */
+inline bool isCliFilter(int argc, const char *const *argv) {
+  try {
+    CliOptions options = parseCliOptions(argc, argv);
+    return !options.help && options.cipher != "rsa" &&
+           options.cipher != "hill";
+  } catch (const CliUsageError &) {
+    return false;
+  }
+}
+
+/**
+ * @brief Запуск шифра в режиме фильтра на файловых дескрипторах
+ * @param argc Число аргументов
+ * @param argv Аргументы командной строки
+ * @param inFd Вход, если входной файл не указан
+ * @param outFd Выход, если выходной файл не указан
+ * @param err Поток для сообщений об ошибках
+ * @return 0 при успехе, 2 при ошибке в параметрах, 1 при прочих ошибках
+ * @details Вход читается read(2) в выровненные по странице блоки, шифруется
+ *          на месте и записывается writev (см. runFilter) без участия
+ *          потоков ввода-вывода. Результат совпадает с runCli
+ */
+inline int runCliFilter(int argc, const char *const *argv, int inFd,
+                        int outFd, std::ostream &err) {
+  CliOptions options;
+  try {
+    options = parseCliOptions(argc, argv);
+  } catch (const CliUsageError &e) {
+    err << "shifres: " << e.what() << '\n' << cliUsage;
+    return 2;
+  }
+
+  try {
+    std::unique_ptr<CliByteStream> stream =
+        CliContext::cached(options)->openBytes(options.decrypt);
+    if (!stream) {
+      throw std::invalid_argument("Шифр " + options.cipher +
+                                  " не работает в режиме фильтра");
+    }
+    std::unique_ptr<FileDescriptor> inputFile, outputFile;
+    if (options.input != "-") {
+      inputFile = std::make_unique<FileDescriptor>(options.input, O_RDONLY);
+      inFd = inputFile->get();
+    }
+    if (options.output != "-") {
+      outputFile = std::make_unique<FileDescriptor>(
+          options.output, O_WRONLY | O_CREAT | O_TRUNC);
+      outFd = outputFile->get();
+    }
+    runFilter(inFd, outFd,
+              [&](std::span<char> chunk) { stream->transform(chunk); });
+  } catch (const CliUsageError &e) {
+    err << "shifres: " << e.what() << '\n' << cliUsage;
+    return 2;
+  } catch (const std::exception &e) {
+    err << "shifres: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
+
+#endif // CLI_H
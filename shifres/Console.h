@@ -0,0 +1,151 @@
+/**
+ * @file console.h
+ * @brief Ввод клавиш с терминала без активного ожидания
+ * @details На время чтения клавиши терминал переводится в неканонический
+ *          режим без эха (termios), а процесс спит в poll() до появления
+ *          ввода, поэтому ожидание не занимает процессор. Последовательности
+ *          стрелок (ESC [ A..D) превращаются в отдельные коды клавиш
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+/**
+ * @brief Коды клавиш, возвращаемые readKey
+ * @details Обычные символы возвращаются кодом байта (от 0 до 255)
+ */
+enum ConsoleKey : int {
+  KeyEnd = -1,    ///< Ввод закончился
+  KeyEscape = 27, ///< Esc
+  KeyUp = 0x100,  ///< Стрелка вверх
+  KeyDown,        ///< Стрелка вниз
+  KeyRight,       ///< Стрелка вправо
+  KeyLeft         ///< Стрелка влево
+};
+
+/**
+ * @class RawTerminal
+ * @brief Неканонический режим терминала без эха на время жизни объекта
+ *
+ * Если стандартный ввод - не терминал, режим не меняется. Сигналы (Ctrl+C)
+ * продолжают работать.
+ */
+class RawTerminal {
+  termios saved;       ///< Исходные настройки терминала
+  bool active = false; ///< Настройки изменены и должны быть восстановлены
+
+public:
+  RawTerminal() {
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved) == 0) {
+      termios raw = saved;
+      raw.c_lflag &= ~(ICANON | ECHO);
+      raw.c_cc[VMIN] = 1;
+      raw.c_cc[VTIME] = 0;
+      active = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+  }
+
+  RawTerminal(const RawTerminal &) = delete;
+  RawTerminal &operator=(const RawTerminal &) = delete;
+
+  ~RawTerminal() {
+    if (active) {
+      tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+  }
+
+  /**
+   * @brief Включён ли неканонический режим
+   * @return true, если ввод - терминал и режим удалось включить
+   */
+  bool isActive() const { return active; }
+};
+
+/**
+ * @brief Чтение одного байта стандартного ввода с ожиданием в poll()
+ * @param timeoutMs Наибольшее время ожидания в миллисекундах (-1 - без
+ * ограничения)
+ * @return Байт или -1 при истечении времени, конце ввода или ошибке
+ */
+inline int readConsoleByte(int timeoutMs) {
+  pollfd fd = {STDIN_FILENO, POLLIN, 0};
+  int ready;
+  do {
+    ready = poll(&fd, 1, timeoutMs);
+  } while (ready < 0 && errno == EINTR);
+  if (ready <= 0) {
+    return -1;
+  }
+  unsigned char c;
+  ssize_t got;
+  do {
+    got = read(STDIN_FILENO, &c, 1);
+  } while (got < 0 && errno == EINTR);
+  return got == 1 ? c : -1;
+}
+
+/**
+ * @brief Код стрелки по последнему байту последовательности ESC [ x
+ * @param c Последний байт
+ * @return Код стрелки или KeyEscape для неизвестной последовательности
+ */
+inline int consoleArrowKey(int c) {
+  switch (c) {
+  case 'A':
+    return KeyUp;
+  case 'B':
+    return KeyDown;
+  case 'C':
+    return KeyRight;
+  case 'D':
+    return KeyLeft;
+  default:
+    return KeyEscape;
+  }
+}
+
+/**
+ * @brief Ожидание нажатия клавиши
+ * @return Код символа, один из кодов ConsoleKey или KeyEnd в конце ввода
+ * @details Одиночный Esc отличается от начала последовательности стрелки
+ *          тем, что за ним в течение 50 мс не приходят следующие байты.
+ *          Если ввод - не терминал (перенаправлен из файла), символы читаются
+ *          из std::cin, так как его буфер может уже содержать данные
+ */
+inline int readKey() {
+  constexpr int escapeTimeoutMs = 50;
+  std::cout.flush();
+  RawTerminal raw;
+  if (!raw.isActive()) {
+    int c = std::cin.get();
+    if (c == EOF) {
+      return KeyEnd;
+    }
+    if (c != KeyEscape || (std::cin.peek() != '[' && std::cin.peek() != 'O')) {
+      return c;
+    }
+    std::cin.get();
+    return consoleArrowKey(std::cin.get());
+  }
+  int c = readConsoleByte(-1);
+  if (c < 0) {
+    return KeyEnd;
+  }
+  if (c != KeyEscape) {
+    return c;
+  }
+  int next = readConsoleByte(escapeTimeoutMs);
+  if (next != '[' && next != 'O') {
+    return KeyEscape;
+  }
+  return consoleArrowKey(readConsoleByte(escapeTimeoutMs));
+}
+
+#endif // CONSOLE_H
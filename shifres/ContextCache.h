@@ -0,0 +1,205 @@
+/**
+ * @file contextcache.h
+ * @brief Кэш подготовленных контекстов шифров с вытеснением давно не
+ * использованных (LRU)
+ * @details Подготовка шифра (таблицы замены, обратные элементы и матрицы,
+ *          секретная экспонента RSA) стоит гораздо дороже, чем обработка
+ *          короткого сообщения, а на практике используется несколько ключей.
+ *          Контексты хранятся по строке (шифр, алфавит, ключ) и разделяются
+ *          всеми вызывающими; кэш разбит на независимые сегменты со своими
+ *          мьютексами, поэтому обращения с разными ключами почти не
+ *          конкурируют
+ */
+
+#ifndef CONTEXT_CACHE_H
+#define CONTEXT_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @class LruCache
+ * @brief Потокобезопасный сегментированный LRU-кэш неизменяемых объектов
+ * @tparam Value Тип хранимых объектов
+ *
+ * Сегмент выбирается по хэшу ключа; в каждом сегменте - список в порядке
+ * использования и хэш-таблица для поиска. Вытесненный объект остаётся жив,
+ * пока на него есть ссылки.
+ */
+template <class Value> class LruCache {
+  /// Ключ и объект
+  using Item = std::pair<std::string, std::shared_ptr<const Value>>;
+
+  /// Сегмент кэша
+  struct Shard {
+    std::mutex mutex;     ///< Защита полей ниже
+    std::list<Item> used; ///< Объекты, недавно использованные - в начале
+    /// Поиск по ключу (строки ключей принадлежат элементам used)
+    std::unordered_map<std::string_view, typename std::list<Item>::iterator>
+        index;
+  };
+
+  std::unique_ptr<Shard[]> shards;    ///< Сегменты
+  size_t shardCount;                  ///< Число сегментов
+  size_t shardCapacity;               ///< Наибольшее число объектов в сегменте
+  std::atomic<uint64_t> hitCount{0};  ///< Число попаданий
+  std::atomic<uint64_t> missCount{0}; ///< Число промахов
+
+  /**
+   * @brief Сегмент для ключа
+   * @param key Ключ
+   * @return Сегмент
+   */
+  Shard &shardFor(std::string_view key) const {
+    return shards[std::hash<std::string_view>()(key) % shardCount];
+  }
+
+public:
+  /**
+   * @brief Создание кэша
+   * @param capacity Наибольшее общее число объектов (не меньше числа
+   * сегментов)
+   * @param segments Число сегментов
+   */
+  explicit LruCache(size_t capacity = 1024, size_t segments = 16)
+      : shards(new Shard[std::max<size_t>(segments, 1)]),
+        shardCount(std::max<size_t>(segments, 1)),
+        shardCapacity(std::max<size_t>(
+            (capacity + shardCount - 1) / shardCount, 1)) {}
+
+  LruCache(const LruCache &) = delete;
+  LruCache &operator=(const LruCache &) = delete;
+
+  /**
+   * @brief Объект по ключу; при промахе создаётся вызовом make
+   * @param key Ключ
+   * @param make Функция без аргументов, возвращающая
+   * std::shared_ptr<const Value>
+   * @return Объект
+   * @throw Исключения make (в этом случае в кэш ничего не добавляется)
+   * @details make вызывается без блокировки сегмента, поэтому долгая
+   *          подготовка одного ключа не задерживает остальные. Если два
+   *          потока одновременно подготовили один ключ, в кэше остаётся
+   *          первый объект, и оба получают его
+   */
+  template <class Make>
+  std::shared_ptr<const Value> get(const std::string &key, Make &&make) {
+    Shard &shard = shardFor(key);
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto found = shard.index.find(key);
+      if (found != shard.index.end()) {
+        shard.used.splice(shard.used.begin(), shard.used, found->second);
+        hitCount.fetch_add(1, std::memory_order_relaxed);
+        return found->second->second;
+      }
+    }
+    missCount.fetch_add(1, std::memory_order_relaxed);
+    std::shared_ptr<const Value> value = make();
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+      shard.used.splice(shard.used.begin(), shard.used, found->second);
+      return found->second->second;
+    }
+    shard.used.emplace_front(key, std::move(value));
+    shard.index.emplace(shard.used.front().first, shard.used.begin());
+    if (shard.used.size() > shardCapacity) {
+      shard.index.erase(shard.used.back().first);
+      shard.used.pop_back();
+    }
+    return shard.used.front().second;
+  }
+
+  /**
+   * @brief Число объектов в кэше
+   * @return Сумма по сегментам
+   */
+  size_t size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shardCount; ++i) {
+      std::lock_guard<std::mutex> lock(shards[i].mutex);
+      total += shards[i].used.size();
+    }
+    return total;
+  }
+
+  /**
+   * @brief Удаление всех объектов
+   */
+  void clear() {
+    for (size_t i = 0; i < shardCount; ++i) {
+      std::lock_guard<std::mutex> lock(shards[i].mutex);
+      shards[i].index.clear();
+      shards[i].used.clear();
+    }
+  }
+
+  /**
+   * @brief Число попаданий с момента создания
+   * @return Число вызовов get, нашедших объект
+   */
+  uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Число промахов с момента создания
+   * @return Число вызовов get, вызвавших make
+   */
+  uint64_t misses() const { return missCount.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Общий кэш процесса для подготовленных объектов типа Value
+ * @tparam Value Тип контекста (AffineCipher, RsaKey, CliContext, ...)
+ * @return Кэш (создаётся при первом вызове)
+ */
+template <class Value> LruCache<Value> &preparedContexts() {
+  static LruCache<Value> cache;
+  return cache;
+}
+
+/**
+ * @brief Ключ кэша из нескольких частей
+ * @param parts Части (шифр, алфавит, ключ, ...)
+ * @return Строка, в которой каждая часть предварена своей длиной, так что
+ * разные наборы частей не дают одинаковых ключей
+ */
+inline std::string contextKey(std::initializer_list<std::string_view> parts) {
+  std::string key;
+  for (std::string_view part : parts) {
+    key += std::to_string(part.size());
+    key += ':';
+    key += part;
+  }
+  return key;
+}
+
+/**
+ * @brief Подготовленный объект из общего кэша процесса
+ * @tparam Value Тип контекста
+ * @param parts Части ключа (см. contextKey)
+ * @param args Аргументы конструктора Value при промахе
+ * @return Общий неизменяемый объект
+ * @throw Исключения конструктора Value
+ */
+template <class Value, class... Args>
+std::shared_ptr<const Value>
+cachedContext(std::initializer_list<std::string_view> parts,
+              const Args &...args) {
+  return preparedContexts<Value>().get(contextKey(parts), [&] {
+    return std::make_shared<const Value>(args...);
+  });
+}
+
+#endif // CONTEXT_CACHE_H
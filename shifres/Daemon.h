@@ -0,0 +1,829 @@
+/**
+ * @file daemon.h
+ * @brief Локальный сервер шифрования на Unix-сокете
+ * @details Сервер принимает запросы (шифр, номер ключа, режим, данные) и
+ *          отвечает результатом с префиксом длины. Ключи задаются при
+ *          запуске, а подготовленные контексты шифров (см. CliContext)
+ *          берутся из общего кэша, поэтому разбор ключа и построение
+ *          таблиц выполняются один раз. Ввод-вывод ведёт один
+ *          поток на epoll, шифрование - фиксированный набор рабочих потоков.
+ *
+ *          Формат запроса (числа в сетевом порядке байт):
+ *          | шифр (1) | режим (1) | 0 (2) | номер ключа (4) | длина (4) |
+ *          данные |. Шифры нумеруются как в меню main.cpp (1 - аффинный,
+ *          ..., 6 - Вернама), режим: 1 - шифрование, 2 - расшифрование.
+ *
+ *          Формат ответа: | статус (1) | 0 (3) | длина (4) | данные |;
+ *          при статусе 1 данные - текст ошибки
+ */
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "Cli.h"
+#include "Filter.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Шифры сервера (номера совпадают с пунктами меню main.cpp)
+ */
+enum class DaemonCipher : uint8_t {
+  Affine = 1,       ///< Аффинный шифр
+  Vigenere = 2,     ///< Шифр Виженера
+  Rsa = 3,          ///< RSA
+  Substitution = 4, ///< Шифр простой замены
+  Hill = 5,         ///< Шифр Хилла
+  Vernam = 6        ///< Шифр Вернама
+};
+
+/**
+ * @brief Режим запроса
+ */
+enum class DaemonMode : uint8_t {
+  Encrypt = 1, ///< Шифрование
+  Decrypt = 2  ///< Расшифрование
+};
+
+/**
+ * @brief Статус ответа
+ */
+enum class DaemonStatus : uint8_t {
+  Ok = 0,   ///< Данные - результат
+  Error = 1 ///< Данные - текст ошибки
+};
+
+/// Размер заголовка запроса
+constexpr size_t daemonRequestHeader = 12;
+/// Размер заголовка ответа
+constexpr size_t daemonResponseHeader = 8;
+/// Наибольший размер данных запроса
+constexpr uint32_t daemonMaxPayload = uint32_t(64) << 20;
+/// Наибольший объём непрочитанных запросов соединения: пока он набран,
+/// сервер не читает из сокета
+constexpr size_t daemonMaxInput = daemonRequestHeader + daemonMaxPayload;
+
+/**
+ * @brief Имя шифра для CliOptions по номеру из запроса
+ * @param cipher Номер шифра
+ * @return Имя или nullptr для неизвестного номера
+ */
+inline const char *daemonCipherName(uint8_t cipher) {
+  static const char *const names[] = {"affine", "vigenere", "rsa",
+                                      "subst",  "hill",     "vernam"};
+  return cipher >= 1 && cipher <= 6 ? names[cipher - 1] : nullptr;
+}
+
+/**
+ * @brief Запись 32-битного числа в сетевом порядке байт
+ * @param out Буфер не короче 4 байт
+ * @param value Число
+ */
+inline void putDaemonU32(char *out, uint32_t value) {
+  value = htonl(value);
+  std::memcpy(out, &value, 4);
+}
+
+/**
+ * @brief Чтение 32-битного числа в сетевом порядке байт
+ * @param in Буфер не короче 4 байт
+ * @return Число
+ */
+inline uint32_t getDaemonU32(const char *in) {
+  uint32_t value;
+  std::memcpy(&value, in, 4);
+  return ntohl(value);
+}
+
+/**
+ * @brief Ответ сервера целиком
+ * @param status Статус
+ * @param body Данные ответа
+ * @return Заголовок и данные
+ */
+inline std::string makeDaemonResponse(DaemonStatus status,
+                                      std::string_view body) {
+  std::string response(daemonResponseHeader, '\0');
+  response[0] = static_cast<char>(status);
+  putDaemonU32(response.data() + 4, body.size());
+  response += body;
+  return response;
+}
+
+/**
+ * @class DaemonKeyStore
+ * @brief Ключи сервера по номерам
+ *
+ * Ключ - строка в формате параметра --key программы shifres и алфавит.
+ * Подготовленные контексты берутся из общего кэша процесса (см.
+ * CliContext::cached), поэтому строятся один раз для каждого ключа.
+ */
+class DaemonKeyStore {
+  /// Ключ и алфавит
+  struct Entry {
+    std::string key;      ///< Ключ
+    std::string alphabet; ///< Алфавит
+  };
+
+  std::unordered_map<uint32_t, Entry> keys; ///< Ключи по номерам
+
+public:
+  /**
+   * @brief Добавление ключа (до запуска сервера)
+   * @param id Номер ключа
+   * @param key Ключ
+   * @param alphabet Алфавит
+   */
+  void add(uint32_t id, const std::string &key,
+           const std::string &alphabet = CliOptions().alphabet) {
+    keys[id] = {key, alphabet};
+  }
+
+  /**
+   * @brief Загрузка ключей из файла
+   * @param path Путь к файлу: строки "номер<TAB>ключ[<TAB>алфавит]", пустые
+   * строки и строки, начинающиеся с '#', пропускаются
+   * @throw std::runtime_error Если файл не открывается или строка
+   * некорректна
+   */
+  void load(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+      throw std::runtime_error("Не удалось открыть файл " + path);
+    }
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      size_t tab = line.find('\t');
+      size_t second = tab == std::string::npos ? tab : line.find('\t', tab + 1);
+      try {
+        if (tab == std::string::npos) {
+          throw std::invalid_argument("нет ключа");
+        }
+        uint32_t id = 0;
+        const char *end = line.data() + tab;
+        auto [last, error] = std::from_chars(line.data(), end, id);
+        if (error != std::errc() || last != end) {
+          throw std::invalid_argument("некорректный номер ключа");
+        }
+        std::string key = line.substr(tab + 1, second - tab - 1);
+        if (second == std::string::npos) {
+          add(id, key);
+        } else {
+          add(id, key, line.substr(second + 1));
+        }
+      } catch (const std::exception &) {
+        throw std::runtime_error(path + ":" + std::to_string(number) +
+                                 ": некорректная строка ключа");
+      }
+    }
+  }
+
+  /**
+   * @brief Подготовленный контекст шифра
+   * @param cipher Номер шифра
+   * @param id Номер ключа
+   * @return Контекст (общий для всех запросов с тем же ключом)
+   * @throw std::invalid_argument Если шифр или ключ неизвестны либо ключ не
+   * подходит шифру
+   * @throw std::runtime_error Если матрица Хилла необратима
+   */
+  std::shared_ptr<const CliContext> context(uint8_t cipher,
+                                            uint32_t id) const {
+    const char *name = daemonCipherName(cipher);
+    if (name == nullptr) {
+      throw std::invalid_argument("Неизвестный шифр " +
+                                  std::to_string(cipher));
+    }
+    auto entry = keys.find(id);
+    if (entry == keys.end()) {
+      throw std::invalid_argument("Неизвестный ключ " + std::to_string(id));
+    }
+    CliOptions options;
+    options.cipher = name;
+    options.key = entry->second.key;
+    options.alphabet = entry->second.alphabet;
+    return CliContext::cached(options);
+  }
+};
+
+/**
+ * @brief Выполнение одного запроса
+ * @param keys Ключи сервера
+ * @param cipher Номер шифра
+ * @param mode Номер режима
+ * @param id Номер ключа
+ * @param payload Данные; изменяются на месте
+ * @return Ответ целиком (ошибки возвращаются ответом со статусом Error)
+ */
+inline std::string handleDaemonRequest(const DaemonKeyStore &keys,
+                                       uint8_t cipher, uint8_t mode,
+                                       uint32_t id, std::string &payload) {
+  try {
+    if (mode != static_cast<uint8_t>(DaemonMode::Encrypt) &&
+        mode != static_cast<uint8_t>(DaemonMode::Decrypt)) {
+      throw std::invalid_argument("Неизвестный режим " + std::to_string(mode));
+    }
+    bool decrypt = mode == static_cast<uint8_t>(DaemonMode::Decrypt);
+    std::shared_ptr<const CliContext> context = keys.context(cipher, id);
+    if (std::unique_ptr<CliByteStream> bytes = context->openBytes(decrypt)) {
+      bytes->transform(payload);
+      return makeDaemonResponse(DaemonStatus::Ok, payload);
+    }
+    std::ostringstream out;
+    std::unique_ptr<CliStream> stream = context->open(decrypt);
+    stream->update(payload, out);
+    stream->finish(out);
+    return makeDaemonResponse(DaemonStatus::Ok, out.str());
+  } catch (const std::exception &e) {
+    return makeDaemonResponse(DaemonStatus::Error, e.what());
+  }
+}
+
+/**
+ * @class DaemonWorkers
+ * @brief Фиксированный набор потоков с общей очередью заданий
+ *
+ * В отличие от ThreadPool, где одно задание делится между всеми потоками,
+ * здесь каждое задание целиком выполняется одним потоком.
+ */
+class DaemonWorkers {
+  std::vector<std::thread> threads;        ///< Рабочие потоки
+  std::mutex mutex;                        ///< Защита полей ниже
+  std::condition_variable wake;            ///< Появилось задание
+  std::deque<std::function<void()>> queue; ///< Очередь заданий
+  bool stopping = false;                   ///< Набор уничтожается
+
+  /**
+   * @brief Цикл рабочего потока
+   */
+  void workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      wake.wait(lock, [&] { return stopping || !queue.empty(); });
+      if (stopping) {
+        return;
+      }
+      std::function<void()> job = std::move(queue.front());
+      queue.pop_front();
+      lock.unlock();
+      job();
+      lock.lock();
+    }
+  }
+
+public:
+  /**
+   * @brief Запуск потоков
+   * @param count Число потоков (0 - по числу ядер)
+   */
+  explicit DaemonWorkers(unsigned count = 0) {
+    if (count == 0) {
+      count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < count; ++i) {
+      threads.emplace_back(&DaemonWorkers::workerLoop, this);
+    }
+  }
+
+  DaemonWorkers(const DaemonWorkers &) = delete;
+  DaemonWorkers &operator=(const DaemonWorkers &) = delete;
+
+  /**
+   * @brief Остановка: невыполненные задания отбрасываются
+   */
+  ~DaemonWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  /**
+   * @brief Постановка задания в очередь
+   * @param job Задание (не должно выбрасывать исключений)
+   */
+  void submit(std::function<void()> job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back(std::move(job));
+    }
+    wake.notify_one();
+  }
+};
+
+/**
+ * @class DaemonServer
+ * @brief Сервер шифрования на Unix-сокете
+ *
+ * Поток, вызвавший run(), принимает соединения и читает/пишет данные без
+ * блокировки через epoll. Полный запрос передаётся рабочему потоку; готовый
+ * ответ возвращается в очередь результатов, а поток epoll будится через
+ * eventfd. Запросы одного соединения выполняются по очереди, поэтому ответы
+ * приходят в порядке запросов; разные соединения обслуживаются параллельно.
+ * После конца входа от клиента (shutdown(SHUT_WR)) уже принятые запросы
+ * выполняются, и соединение закрывается после отправки всех ответов.
+ */
+class DaemonServer {
+  /// Состояние соединения
+  struct Connection {
+    int fd = -1;          ///< Сокет клиента
+    std::string input;    ///< Принятые, ещё не разобранные байты
+    std::string output;   ///< Ответы, ещё не отправленные клиенту
+    size_t written = 0;   ///< Отправленная часть output
+    bool busy = false;    ///< Запрос выполняется рабочим потоком
+    bool eof = false;     ///< Клиент закончил передачу
+    bool closing = false; ///< Закрыть после отправки output
+    uint32_t events = 0;  ///< Ожидаемые события epoll
+  };
+
+  /// Метка epoll для слушающего сокета
+  static constexpr uint64_t listenTag = 0;
+  /// Метка epoll для eventfd пробуждения
+  static constexpr uint64_t wakeTag = 1;
+
+  const DaemonKeyStore &keys;        ///< Ключи
+  std::string path;                  ///< Путь сокета
+  int listenFd = -1;                 ///< Слушающий сокет
+  int epollFd = -1;                  ///< Экземпляр epoll
+  int wakeFd = -1;                   ///< eventfd для пробуждения потока epoll
+  std::atomic<bool> stopping{false}; ///< Запрошена остановка
+  uint64_t nextTag = 2;              ///< Метка следующего соединения
+  /// Открытые соединения по меткам epoll
+  std::unordered_map<uint64_t, Connection> connections;
+  std::mutex doneMutex; ///< Защита done
+  /// Готовые ответы: метка соединения и ответ
+  std::vector<std::pair<uint64_t, std::string>> done;
+  /// Рабочие потоки (останавливаются в деструкторе до закрытия дескрипторов)
+  std::optional<DaemonWorkers> workers;
+
+  /**
+   * @brief Исключение с описанием системной ошибки
+   * @param what Что не удалось сделать
+   */
+  [[noreturn]] static void fail(const std::string &what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+  }
+
+  /**
+   * @brief Обновление набора ожидаемых событий соединения
+   * @param tag Метка соединения
+   * @param connection Соединение
+   * @details Чтение ждётся, пока клиент не закончил передачу и входной буфер
+   *          не заполнен до daemonMaxInput; запись - пока есть неотправленные
+   *          ответы
+   */
+  void watch(uint64_t tag, Connection &connection) {
+    uint32_t events = 0;
+    if (!connection.eof && connection.input.size() < daemonMaxInput) {
+      events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (connection.written < connection.output.size()) {
+      events |= EPOLLOUT;
+    }
+    if (events == connection.events) {
+      return;
+    }
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = tag;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+    connection.events = events;
+  }
+
+  /**
+   * @brief Закрытие соединения
+   * @param tag Метка соединения
+   */
+  void drop(uint64_t tag) {
+    auto found = connections.find(tag);
+    if (found != connections.end()) {
+      close(found->second.fd);
+      connections.erase(found);
+    }
+  }
+
+  /**
+   * @brief Прием всех ожидающих соединений
+   */
+  void acceptAll() {
+    while (true) {
+      int fd = accept4(listenFd, nullptr, nullptr,
+                       SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+        return;
+      }
+      uint64_t tag = nextTag++;
+      epoll_event event{};
+      event.events = EPOLLIN | EPOLLRDHUP;
+      event.data.u64 = tag;
+      if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        close(fd);
+        continue;
+      }
+      Connection connection;
+      connection.fd = fd;
+      connection.events = event.events;
+      connections.emplace(tag, std::move(connection));
+    }
+  }
+
+  /**
+   * @brief Отправка накопленных ответов без блокировки
+   * @param tag Метка соединения
+   * @return false, если соединение закрыто
+   */
+  bool flush(uint64_t tag) {
+    Connection &connection = connections.at(tag);
+    while (connection.written < connection.output.size()) {
+      ssize_t sent = send(connection.fd,
+                          connection.output.data() + connection.written,
+                          connection.output.size() - connection.written,
+                          MSG_NOSIGNAL);
+      if (sent < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          watch(tag, connection);
+          return true;
+        }
+        drop(tag);
+        return false;
+      }
+      connection.written += sent;
+    }
+    connection.output.clear();
+    connection.written = 0;
+    watch(tag, connection);
+    if (connection.closing) {
+      drop(tag);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Передача следующего полного запроса рабочему потоку
+   * @param tag Метка соединения
+   * @details Запрос с данными больше daemonMaxPayload получает ответ с
+   *          ошибкой, после которого соединение закрывается. Если клиент
+   *          закончил передачу и полных запросов не осталось, соединение
+   *          закрывается после отправки ответов
+   */
+  void dispatch(uint64_t tag) {
+    Connection &connection = connections.at(tag);
+    if (connection.closing) {
+      return;
+    }
+    if (connection.busy) {
+      watch(tag, connection);
+      return;
+    }
+    bool complete = false;
+    if (connection.input.size() >= daemonRequestHeader) {
+      uint32_t length = getDaemonU32(connection.input.data() + 8);
+      if (length > daemonMaxPayload) {
+        connection.output +=
+            makeDaemonResponse(DaemonStatus::Error, "Слишком большой запрос");
+        connection.closing = true;
+        flush(tag);
+        return;
+      }
+      complete = connection.input.size() >= daemonRequestHeader + length;
+    }
+    if (!complete) {
+      if (connection.eof) {
+        connection.closing = true;
+        flush(tag);
+      } else {
+        watch(tag, connection);
+      }
+      return;
+    }
+    const char *header = connection.input.data();
+    uint32_t length = getDaemonU32(header + 8);
+    uint8_t cipher = header[0];
+    uint8_t mode = header[1];
+    uint32_t id = getDaemonU32(header + 4);
+    std::string payload;
+    if (connection.input.size() == daemonRequestHeader + length) {
+      connection.input.erase(0, daemonRequestHeader);
+      payload.swap(connection.input);
+    } else {
+      payload = connection.input.substr(daemonRequestHeader, length);
+      connection.input.erase(0, daemonRequestHeader + length);
+    }
+    connection.busy = true;
+    watch(tag, connection);
+    workers->submit([this, tag, cipher, mode, id,
+                     payload = std::move(payload)]() mutable {
+      std::string response =
+          handleDaemonRequest(keys, cipher, mode, id, payload);
+      {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done.emplace_back(tag, std::move(response));
+      }
+      uint64_t one = 1;
+      ssize_t ignored = write(wakeFd, &one, sizeof(one));
+      (void)ignored;
+    });
+  }
+
+  /**
+   * @brief Чтение доступных данных соединения (не больше daemonMaxInput в
+   * буфере)
+   * @param tag Метка соединения
+   * @details Конец входа не закрывает соединение: принятые запросы
+   *          выполняются, а ответы отправляются (см. dispatch)
+   */
+  void receive(uint64_t tag) {
+    Connection &connection = connections.at(tag);
+    char buffer[65536];
+    while (!connection.eof && connection.input.size() < daemonMaxInput) {
+      ssize_t got = recv(connection.fd, buffer, sizeof(buffer), 0);
+      if (got > 0) {
+        connection.input.append(buffer, got);
+        continue;
+      }
+      if (got == 0) {
+        connection.eof = true;
+        break;
+      }
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      drop(tag);
+      return;
+    }
+    dispatch(tag);
+  }
+
+  /**
+   * @brief Доставка готовых ответов соединениям
+   */
+  void deliver() {
+    uint64_t counter;
+    ssize_t ignored = read(wakeFd, &counter, sizeof(counter));
+    (void)ignored;
+    std::vector<std::pair<uint64_t, std::string>> ready;
+    {
+      std::lock_guard<std::mutex> lock(doneMutex);
+      ready.swap(done);
+    }
+    for (auto &[tag, response] : ready) {
+      auto found = connections.find(tag);
+      if (found == connections.end()) {
+        continue; // клиент отключился, пока запрос выполнялся
+      }
+      found->second.output += response;
+      found->second.busy = false;
+      if (flush(tag)) {
+        dispatch(tag);
+      }
+    }
+  }
+
+public:
+  /**
+   * @brief Создание сокета и запуск рабочих потоков
+   * @param socketPath Путь Unix-сокета (существующий файл заменяется)
+   * @param keyStore Ключи (должны жить дольше сервера)
+   * @param workerCount Число рабочих потоков (0 - по числу ядер)
+   * @throw std::runtime_error Если сокет не удалось создать
+   */
+  DaemonServer(const std::string &socketPath, const DaemonKeyStore &keyStore,
+               unsigned workerCount = 0)
+      : keys(keyStore), path(socketPath),
+        workers(std::in_place, workerCount) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+      throw std::runtime_error("Слишком длинный путь сокета " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    try {
+      listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+      if (listenFd < 0) {
+        fail("Не удалось создать сокет");
+      }
+      unlink(path.c_str());
+      if (bind(listenFd, reinterpret_cast<sockaddr *>(&address),
+               sizeof(address)) != 0 ||
+          listen(listenFd, SOMAXCONN) != 0) {
+        fail("Не удалось открыть сокет " + path);
+      }
+      epollFd = epoll_create1(EPOLL_CLOEXEC);
+      wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (epollFd < 0 || wakeFd < 0) {
+        fail("Не удалось создать epoll");
+      }
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.u64 = listenTag;
+      epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+      event.data.u64 = wakeTag;
+      epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    } catch (...) {
+      workers.reset();
+      release();
+      throw;
+    }
+  }
+
+  DaemonServer(const DaemonServer &) = delete;
+  DaemonServer &operator=(const DaemonServer &) = delete;
+
+  ~DaemonServer() {
+    workers.reset();
+    release();
+  }
+
+  /**
+   * @brief Цикл обработки событий до вызова stop()
+   */
+  void run() {
+    epoll_event events[64];
+    while (!stopping) {
+      int count = epoll_wait(epollFd, events, 64, -1);
+      if (count < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        fail("Ошибка epoll_wait");
+      }
+      for (int i = 0; i < count; ++i) {
+        uint64_t tag = events[i].data.u64;
+        if (tag == listenTag) {
+          acceptAll();
+        } else if (tag == wakeTag) {
+          deliver();
+        } else if (connections.count(tag) != 0) {
+          if ((events[i].events & (EPOLLHUP | EPOLLERR)) &&
+              connections.at(tag).eof) {
+            drop(tag); // клиент закрыл сокет: ответы уже некуда отправить
+            continue;
+          }
+          if (events[i].events & EPOLLOUT) {
+            if (!flush(tag)) {
+              continue;
+            }
+          }
+          if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            receive(tag);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Остановка run() (можно вызывать из любого потока)
+   */
+  void stop() {
+    stopping = true;
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+  }
+
+private:
+  /**
+   * @brief Закрытие всех дескрипторов и удаление файла сокета
+   */
+  void release() {
+    for (auto &[tag, connection] : connections) {
+      close(connection.fd);
+    }
+    connections.clear();
+    for (int *fd : {&wakeFd, &epollFd}) {
+      if (*fd >= 0) {
+        close(*fd);
+        *fd = -1;
+      }
+    }
+    if (listenFd >= 0) {
+      close(listenFd);
+      listenFd = -1;
+      unlink(path.c_str());
+    }
+  }
+};
+
+/**
+ * @class DaemonClient
+ * @brief Клиент сервера шифрования (одно соединение, запросы по очереди)
+ */
+class DaemonClient {
+  int fd = -1; ///< Сокет
+
+  /**
+   * @brief Чтение ровно size байт
+   * @param data Буфер
+   * @param size Число байт
+   * @throw std::runtime_error Если соединение закрыто раньше
+   */
+  void readExact(char *data, size_t size) {
+    while (size > 0) {
+      size_t got = readSome(fd, data, size);
+      if (got == 0) {
+        throw std::runtime_error("Сервер закрыл соединение");
+      }
+      data += got;
+      size -= got;
+    }
+  }
+
+public:
+  /**
+   * @brief Подключение к серверу
+   * @param socketPath Путь Unix-сокета
+   * @throw std::runtime_error Если подключиться не удалось
+   */
+  explicit DaemonClient(const std::string &socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+      throw std::runtime_error("Слишком длинный путь сокета " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address),
+                          sizeof(address)) != 0) {
+      std::string reason = std::strerror(errno);
+      if (fd >= 0) {
+        close(fd);
+      }
+      throw std::runtime_error("Не удалось подключиться к " + socketPath +
+                               ": " + reason);
+    }
+  }
+
+  DaemonClient(const DaemonClient &) = delete;
+  DaemonClient &operator=(const DaemonClient &) = delete;
+
+  ~DaemonClient() { close(fd); }
+
+  /**
+   * @brief Запрос к серверу
+   * @param cipher Шифр
+   * @param id Номер ключа
+   * @param mode Режим
+   * @param payload Данные
+   * @return Результат
+   * @throw std::runtime_error С текстом ошибки сервера или при ошибке связи
+   */
+  std::string call(DaemonCipher cipher, uint32_t id, DaemonMode mode,
+                   std::string_view payload) {
+    char header[daemonRequestHeader] = {};
+    header[0] = static_cast<char>(cipher);
+    header[1] = static_cast<char>(mode);
+    putDaemonU32(header + 4, id);
+    putDaemonU32(header + 8, payload.size());
+    iovec parts[2] = {{header, sizeof(header)},
+                      {const_cast<char *>(payload.data()), payload.size()}};
+    writeAll(fd, parts);
+
+    char response[daemonResponseHeader];
+    readExact(response, sizeof(response));
+    std::string body(getDaemonU32(response + 4), '\0');
+    readExact(body.data(), body.size());
+    if (response[0] != static_cast<char>(DaemonStatus::Ok)) {
+      throw std::runtime_error(body);
+    }
+    return body;
+  }
+};
+
+#endif // DAEMON_H
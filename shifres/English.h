@@ -0,0 +1,36 @@
+/**
+ * @file english.h
+ * @brief Статистика английского языка для криптоанализа
+ * @details Общая таблица частот букв, из которой строятся модели открытого
+ *          текста для вскрытия шифров Виженера и Вернама
+ */
+
+#ifndef ENGLISH_H
+#define ENGLISH_H
+
+#include <array>
+#include <vector>
+
+/// Частоты букв a-z в английском тексте, в процентах
+inline constexpr std::array<double, 26> englishLetterPercents = {
+    8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.15, 0.77, 4.0, 2.4,
+    6.7, 7.5, 1.9, 0.095, 6.0, 6.3, 9.1, 2.8, 0.98, 2.4, 0.15, 2.0, 0.074};
+
+/**
+ * @brief Частоты букв английского языка
+ * @return Частоты символов алфавита a-z (сумма равна 1)
+ */
+inline std::vector<double> englishLetterFrequencies() {
+  std::vector<double> f(englishLetterPercents.begin(),
+                        englishLetterPercents.end());
+  double sum = 0;
+  for (double v : f) {
+    sum += v;
+  }
+  for (double &v : f) {
+    v /= sum;
+  }
+  return f;
+}
+
+#endif // ENGLISH_H
@@ -0,0 +1,203 @@
+/**
+ * @file filter.h
+ * @brief Обработка потока байтов в духе tr и gzip: read(2) -> шифр -> writev
+ * @details Вход читается прямо в выровненные по странице блоки, шифр
+ *          применяется к каждой прочитанной порции на месте, пока она ещё в
+ *          кэше, а заполненные блоки записываются одним вызовом writev.
+ *          Потоки ввода-вывода C++ и форматирование не используются
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+/// Размер одного блока буфера фильтра (помещается в L2)
+constexpr size_t filterBlockSize = size_t(256) << 10;
+/// Число блоков, записываемых одним вызовом writev
+constexpr size_t filterBlockCount = 4;
+
+/**
+ * @class FileDescriptor
+ * @brief Владеющая обёртка над файловым дескриптором
+ */
+class FileDescriptor {
+  int fd = -1; ///< Дескриптор
+
+public:
+  /**
+   * @brief Открытие файла
+   * @param path Путь к файлу
+   * @param flags Флаги open(2)
+   * @param mode Права создаваемого файла
+   * @throw std::runtime_error Если файл не удалось открыть
+   */
+  FileDescriptor(const std::string &path, int flags, mode_t mode = 0644) {
+    do {
+      fd = open(path.c_str(), flags | O_CLOEXEC, mode);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) {
+      throw std::runtime_error("Не удалось открыть файл " + path + ": " +
+                               std::strerror(errno));
+    }
+  }
+
+  FileDescriptor(const FileDescriptor &) = delete;
+  FileDescriptor &operator=(const FileDescriptor &) = delete;
+
+  ~FileDescriptor() { close(fd); }
+
+  /**
+   * @brief Номер дескриптора
+   * @return Дескриптор
+   */
+  int get() const { return fd; }
+};
+
+/**
+ * @brief Освобождение памяти, выделенной std::aligned_alloc
+ */
+struct AlignedFree {
+  void operator()(char *p) const { std::free(p); }
+};
+
+/// Буфер, выровненный по границе страницы
+using AlignedBuffer = std::unique_ptr<char, AlignedFree>;
+
+/**
+ * @brief Размер страницы памяти
+ * @return Размер страницы в байтах
+ */
+inline size_t pageSize() {
+  static const size_t size = [] {
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? static_cast<size_t>(page) : size_t(4096);
+  }();
+  return size;
+}
+
+/**
+ * @brief Выделение буфера, выровненного по странице
+ * @param size Размер (округляется вверх до кратного странице)
+ * @return Буфер
+ * @throw std::bad_alloc Если память не выделена
+ */
+inline AlignedBuffer allocatePageAligned(size_t size) {
+  size_t page = pageSize();
+  size = (size + page - 1) / page * page;
+  char *data = static_cast<char *>(std::aligned_alloc(page, size));
+  if (data == nullptr) {
+    throw std::bad_alloc();
+  }
+  return AlignedBuffer(data);
+}
+
+/**
+ * @brief Чтение доступных байтов с повтором при EINTR
+ * @param fd Дескриптор
+ * @param data Буфер
+ * @param size Размер буфера
+ * @return Число прочитанных байтов (0 - конец входа)
+ * @throw std::runtime_error При ошибке чтения
+ */
+inline size_t readSome(int fd, char *data, size_t size) {
+  ssize_t got;
+  do {
+    got = read(fd, data, size);
+  } while (got < 0 && errno == EINTR);
+  if (got < 0) {
+    throw std::runtime_error(std::string("Ошибка чтения: ") +
+                             std::strerror(errno));
+  }
+  return static_cast<size_t>(got);
+}
+
+/**
+ * @brief Запись всех фрагментов с дозаписью после частичной записи
+ * @param fd Дескриптор
+ * @param parts Фрагменты; изменяются в процессе записи
+ * @throw std::runtime_error При ошибке записи
+ */
+inline void writeAll(int fd, std::span<iovec> parts) {
+  while (!parts.empty()) {
+    ssize_t written = writev(fd, parts.data(), parts.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error(std::string("Ошибка записи: ") +
+                               std::strerror(errno));
+    }
+    size_t left = static_cast<size_t>(written);
+    while (!parts.empty() && left >= parts.front().iov_len) {
+      left -= parts.front().iov_len;
+      parts = parts.subspan(1);
+    }
+    if (left > 0) {
+      iovec &part = parts.front();
+      part.iov_base = static_cast<char *>(part.iov_base) + left;
+      part.iov_len -= left;
+    }
+  }
+}
+
+/**
+ * @brief Пропуск потока байтов через преобразование на месте
+ * @param inFd Дескриптор входа
+ * @param outFd Дескриптор выхода
+ * @param transform Вызывается с каждой прочитанной порцией (std::span<char>)
+ * по порядку; должно сохранять длину порции
+ * @throw std::runtime_error При ошибке чтения или записи; исключения
+ * transform передаются дальше
+ * @details Блоки по filterBlockSize байт заполняются последовательно; порция
+ *          из read(2) преобразуется сразу после чтения. Когда все
+ *          filterBlockCount блоков заполнены (или вход закончился), они
+ *          записываются одним writev, так что на мегабайт данных приходится
+ *          один системный вызов записи независимо от размера порций,
+ *          которые отдаёт канал
+ */
+template <class Transform>
+void runFilter(int inFd, int outFd, Transform &&transform) {
+  std::vector<AlignedBuffer> blocks;
+  for (size_t i = 0; i < filterBlockCount; ++i) {
+    blocks.push_back(allocatePageAligned(filterBlockSize));
+  }
+  std::vector<iovec> parts(filterBlockCount);
+  bool end = false;
+  while (!end) {
+    size_t count = 0;
+    for (AlignedBuffer &block : blocks) {
+      size_t filled = 0;
+      while (filled < filterBlockSize) {
+        size_t got =
+            readSome(inFd, block.get() + filled, filterBlockSize - filled);
+        if (got == 0) {
+          end = true;
+          break;
+        }
+        transform(std::span<char>(block.get() + filled, got));
+        filled += got;
+      }
+      if (filled > 0) {
+        parts[count++] = {block.get(), filled};
+      }
+      if (end) {
+        break;
+      }
+    }
+    writeAll(outFd, std::span<iovec>(parts.data(), count));
+  }
+}
+
+#endif // FILTER_H
@@ -1,133 +1,799 @@
 #ifndef HILL_CIPHER_H
 #define HILL_CIPHER_H
 
+#include "Cipher.h"
+#include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HILL_AVX2_KERNEL 1
+#endif
+
+/**
+ * @brief Построение таблицы обратных элементов кольца вычетов по модулю m
+ * @param m Модуль
+ * @return Вектор длины m: для обратимого a - его обратный, для остальных 0
+ * @details Обратные находятся расширенным алгоритмом Евклида, поэтому таблица
+ *          строится за O(m log m) один раз и дальше используется при поиске
+ *          ведущих элементов
+ */
+inline std::vector<int> buildUnitInverseTable(int m) {
+  std::vector<int> table(m, 0);
+  for (int a = 1; a < m; ++a) {
+    int r0 = m, r1 = a, t0 = 0, t1 = 1;
+    while (r1 != 0) {
+      int q = r0 / r1;
+      std::swap(r0, r1);
+      r1 -= q * r0;
+      std::swap(t0, t1);
+      t1 -= q * t0;
+    }
+    if (r0 == 1) {
+      table[a] = (t0 % m + m) % m;
+    }
+  }
+  return table;
+}
+
+/**
+ * @brief Обращение квадратной матрицы над кольцом вычетов методом
+ * Гаусса-Жордана
+ * @param matrix Матрица n x n, записанная по строкам, с элементами из [0, m)
+ * @param n Размер матрицы
+ * @param m Модуль
+ * @param units Таблица обратных элементов (см. buildUnitInverseTable)
+ * @param inverse Результат - обратная матрица по строкам
+ * @return true, если матрица обратима по модулю m
+ * @details Ведущим элементом выбирается обратимый по модулю m элемент столбца.
+ *          Если такого нет (для составного m это возможно и у обратимой
+ *          матрицы), строки столбца сводятся алгоритмом Евклида, после чего
+ *          на диагонали оказывается их НОД
+ */
+inline bool invertMatrixMod(std::vector<int> matrix, int n, int m,
+                            const std::vector<int> &units,
+                            std::vector<int> &inverse) {
+  inverse.assign(n * n, 0);
+  for (int i = 0; i < n; ++i) {
+    inverse[i * n + i] = 1 % m;
+  }
+
+  auto swapRows = [&](int r1, int r2) {
+    for (int j = 0; j < n; ++j) {
+      std::swap(matrix[r1 * n + j], matrix[r2 * n + j]);
+      std::swap(inverse[r1 * n + j], inverse[r2 * n + j]);
+    }
+  };
+  // row[dst] -= factor * row[src]
+  auto subtractRow = [&](int dst, int src, int factor) {
+    if (factor == 0) {
+      return;
+    }
+    int neg = m - factor;
+    for (int j = 0; j < n; ++j) {
+      matrix[dst * n + j] =
+          (matrix[dst * n + j] + neg * matrix[src * n + j]) % m;
+      inverse[dst * n + j] =
+          (inverse[dst * n + j] + neg * inverse[src * n + j]) % m;
+    }
+  };
+
+  for (int col = 0; col < n; ++col) {
+    int pivot = -1;
+    for (int r = col; r < n; ++r) {
+      if (units[matrix[r * n + col]] != 0) {
+        pivot = r;
+        break;
+      }
+    }
+
+    if (pivot == -1) {
+      for (int r = col + 1; r < n; ++r) {
+        while (matrix[r * n + col] != 0) {
+          subtractRow(col, r, matrix[col * n + col] / matrix[r * n + col]);
+          swapRows(col, r);
+        }
+      }
+      if (units[matrix[col * n + col]] == 0) {
+        return false;
+      }
+      pivot = col;
+    }
+
+    if (pivot != col) {
+      swapRows(pivot, col);
+    }
+
+    int scale = units[matrix[col * n + col]];
+    for (int j = 0; j < n; ++j) {
+      matrix[col * n + j] = matrix[col * n + j] * scale % m;
+      inverse[col * n + j] = inverse[col * n + j] * scale % m;
+    }
+
+    for (int r = 0; r < n; ++r) {
+      if (r != col) {
+        subtractRow(r, col, matrix[r * n + col]);
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @class ModReducer
+ * @brief Приведение неотрицательных чисел по фиксированному модулю без деления
+ * @details Для модуля - степени двойки используется маска, для остальных -
+ *          редукция Барретта с константой floor(2^32 / m), вычисленной один
+ *          раз. Корректна для любых 32-битных беззнаковых аргументов
+ */
+class ModReducer {
+  uint32_t modulus; ///< Модуль m
+  uint32_t mask;    ///< m - 1, если m - степень двойки
+  uint64_t barrett; ///< floor(2^32 / m)
+  bool powerOfTwo;  ///< Можно ли приводить маской
+
+public:
+  /**
+   * @brief Конструктор, вычисляющий константы редукции
+   * @param m Модуль (не меньше 1)
+   */
+  explicit ModReducer(uint32_t m)
+      : modulus(m), mask(m - 1), barrett((uint64_t(1) << 32) / m),
+        powerOfTwo((m & (m - 1)) == 0) {}
+
+  /**
+   * @brief Вычисление x mod m
+   * @param x Неотрицательное значение
+   * @return Остаток от деления x на m
+   */
+  uint32_t reduce(uint32_t x) const {
+    if (powerOfTwo) {
+      return x & mask;
+    }
+    uint32_t q = static_cast<uint32_t>((x * barrett) >> 32);
+    uint32_t r = x - q * modulus;
+    return r >= modulus ? r - modulus : r;
+  }
+
+  /**
+   * @brief Получение модуля
+   * @return Модуль m
+   */
+  uint32_t get() const { return modulus; }
+};
+
+#ifdef HILL_AVX2_KERNEL
+/**
+ * @brief Проверка поддержки AVX2 процессором
+ * @return true, если можно вызывать AVX2-ядро
+ */
+inline bool hillCpuHasAvx2() {
+  static const bool has = __builtin_cpu_supports("avx2");
+  return has;
+}
+
+/**
+ * @brief Приведение восьми 32-битных сумм по модулю m
+ * @param x Неотрицательные суммы, меньшие 2^24
+ * @param m Модуль в каждом элементе
+ * @param invM 1/m в каждом элементе
+ * @return Остатки от деления на m
+ * @details Частное оценивается умножением на 1/m в float (для x < 2^24
+ *          ошибка не больше единицы) и поправляется в обе стороны
+ */
+__attribute__((target("avx2"))) inline __m256i
+hillReduceAvx2(__m256i x, __m256i m, __m256 invM) {
+  __m256 q = _mm256_floor_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(x), invM));
+  __m256i r =
+      _mm256_sub_epi32(x, _mm256_mullo_epi32(_mm256_cvttps_epi32(q), m));
+  __m256i negative = _mm256_cmpgt_epi32(_mm256_setzero_si256(), r);
+  r = _mm256_add_epi32(r, _mm256_and_si256(m, negative));
+  __m256i tooBig =
+      _mm256_cmpgt_epi32(r, _mm256_sub_epi32(m, _mm256_set1_epi32(1)));
+  return _mm256_sub_epi32(r, _mm256_and_si256(m, tooBig));
+}
+
+/**
+ * @brief AVX2-ядро умножения блоков текста на матрицу Хилла
+ * @param q Индексы символов (int16), перед ними n-1 и после них n элементов
+ * доступны для чтения
+ * @param bands Ленточные веса матрицы (см. HillCipher::buildBandWeights)
+ * @param n Размер матрицы
+ * @param phases Число фаз весов, n / НОД(n, 16)
+ * @param count Число обрабатываемых индексов, кратное 16 (начало - граница
+ * блока)
+ * @param m Модуль
+ * @param out Результирующие индексы
+ * @details Текст рассматривается как последовательность, в которой выход
+ *          x равен сумме W_d[x] * p[x + d] по сдвигам d от -(n-1) до n-1, где
+ *          веса W_d периодичны с периодом n. Соседние сдвиги объединяются в
+ *          пары для vpmaddwd: чётные и нечётные позиции считаются отдельно и
+ *          затем перемежаются. Все n произведений копятся в 32 битах, и
+ *          приведение по модулю выполняется один раз на выходной символ
+ */
+__attribute__((target("avx2"))) inline void
+hillBandKernelAvx2(const int16_t *q, const int16_t *bands, int n, int phases,
+                   size_t count, int m, unsigned char *out) {
+  const __m256i mVec = _mm256_set1_epi32(m);
+  const __m256 invM = _mm256_set1_ps(1.0f / m);
+  const __m256i zero = _mm256_setzero_si256();
+  int phase = 0;
+  for (size_t i = 0; i < count; i += 16) {
+    const int16_t *w = bands + phase * n * 32;
+    __m256i even = zero;
+    __m256i odd = zero;
+    for (int k = 0; k < n; ++k) {
+      const int16_t *src = q + i + 2 * k - (n - 1);
+      __m256i pe = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+      __m256i po =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 1));
+      __m256i we =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + k * 32));
+      __m256i wo = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(w + k * 32 + 16));
+      even = _mm256_add_epi32(even, _mm256_madd_epi16(pe, we));
+      odd = _mm256_add_epi32(odd, _mm256_madd_epi16(po, wo));
+    }
+    even = hillReduceAvx2(even, mVec, invM);
+    odd = hillReduceAvx2(odd, mVec, invM);
+    __m256i packed = _mm256_or_si256(even, _mm256_slli_epi32(odd, 16));
+    packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(packed, zero), 0xD8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm256_castsi256_si128(packed));
+    if (++phase == phases) {
+      phase = 0;
+    }
+  }
+}
+#endif
+
 /**
  * @class HillCipher
- * @brief Реализация шифра Хилла для 2x2 матриц
+ * @brief Реализация шифра Хилла для квадратных матриц произвольного размера
+ *
+ * Алфавит задаётся строкой однобайтовых символов (например, a-z, русский
+ * алфавит в однобайтовой кодировке или все 256 байт), модулем служит его
+ * длина.
  */
-class HillCipher {
-private:
-  std::vector<std::vector<int>> keyMatrix;
-  std::vector<std::vector<int>> inverseMatrix;
+class HillCipher : public CipherBase<HillCipher> {
+  friend class CipherBase<HillCipher>;
+
+  std::vector<int> keyMatrix;     ///< Матрица ключа по строкам
+  std::vector<int> inverseMatrix; ///< Обратная матрица по строкам
   int matrixSize;
+  std::string alphabet;                  ///< Символы алфавита по порядку
+  std::array<int, 256> symbolIndex;      ///< Индекс символа в алфавите или -1
+  ModReducer reducer;                    ///< Приведение по модулю m
+  char padSymbol;                        ///< Символ дополнения последнего блока
+  std::vector<uint16_t> encryptDigraphs; ///< Биграммы для ключа 2x2
+  std::vector<uint16_t> decryptDigraphs; ///< Биграммы для обратной матрицы
+  std::vector<int16_t> encryptBands;     ///< Ленточные веса ключа для SIMD
+  std::vector<int16_t> decryptBands;     ///< Ленточные веса обратной матрицы
+  int bandPhases = 0;                    ///< Число фаз ленточных весов
+
+  static constexpr size_t tileSymbols = 4096; ///< Размер тайла SIMD-пути
 
   /**
-   * @brief Вычисление значения по модулю 26
-   * @param value Исходное значение
-   * @return Значение по модулю 26
+   * @brief Вычисление обратной матрицы методом Гаусса-Жордана по модулю m
+   * @throw std::runtime_error Если матрица необратима
    */
-  int mod26(int value) { return (value % 26 + 26) % 26; }
+  void calculateInverse() {
+    int m = reducer.get();
+    if (!invertMatrixMod(keyMatrix, matrixSize, m, buildUnitInverseTable(m),
+                         inverseMatrix)) {
+      throw std::runtime_error("Матрица необратима");
+    }
+  }
 
   /**
-   * @brief Вычисление обратной матрицы
-   * @throw std::runtime_error Если матрица не 2x2 или необратима
+   * @brief Построение таблицы преобразования биграмм для матрицы 2x2
+   * @param matrix Матрица ключа или обратная матрица
+   * @return Таблица из m*m элементов: по индексу i1*m+i2 входной биграммы
+   * хранятся два выходных символа (первый в младшем байте)
+   * @details Для 26 букв таблица занимает 1,3 КБ, для всех 256 байт - 128 КБ,
+   *          и шифрование блока сводится к одному чтению из неё
    */
-  void calculateInverse() {
-    if (matrixSize != 2) {
-      throw std::runtime_error("Поддерживаются только матрицы 2x2");
+  std::vector<uint16_t> buildDigraphTable(const std::vector<int> &matrix) {
+    int m = reducer.get();
+    std::vector<uint16_t> table(m * m);
+    for (int i1 = 0; i1 < m; ++i1) {
+      for (int i2 = 0; i2 < m; ++i2) {
+        unsigned char e1 = alphabet[reducer.reduce(matrix[0] * i1 +
+                                                   matrix[1] * i2)];
+        unsigned char e2 = alphabet[reducer.reduce(matrix[2] * i1 +
+                                                   matrix[3] * i2)];
+        table[i1 * m + i2] = static_cast<uint16_t>(e1 | (e2 << 8));
+      }
     }
+    return table;
+  }
 
-    int det =
-        keyMatrix[0][0] * keyMatrix[1][1] - keyMatrix[0][1] * keyMatrix[1][0];
-    det = mod26(det);
+  /**
+   * @brief Построение ленточных весов матрицы для AVX2-ядра
+   * @param matrix Матрица ключа или обратная матрица
+   * @return Веса по фазам, парам сдвигов и чётности позиций, по 16 int16
+   * @details Для позиции x и сдвига d вес равен M[r][r + d], где r = x mod n,
+   *          и нулю, если r + d выходит за пределы блока. Пара k объединяет
+   *          сдвиги d = 2k - (n-1) и d + 1
+   */
+  std::vector<int16_t> buildBandWeights(const std::vector<int> &matrix) {
+    int n = matrixSize;
+    auto weight = [&](int x, int d) {
+      int r = x % n;
+      int col = r + d;
+      return static_cast<int16_t>(
+          col >= 0 && col < n ? matrix[r * n + col] : 0);
+    };
+    std::vector<int16_t> bands(bandPhases * n * 32);
+    for (int p = 0; p < bandPhases; ++p) {
+      int base = 16 * p % n;
+      for (int k = 0; k < n; ++k) {
+        int d = 2 * k - (n - 1);
+        for (int parity = 0; parity < 2; ++parity) {
+          int16_t *w = &bands[((p * n + k) * 2 + parity) * 16];
+          for (int lane = 0; lane < 8; ++lane) {
+            int x = base + 2 * lane + parity;
+            w[2 * lane] = weight(x, d);
+            w[2 * lane + 1] = weight(x, d + 1);
+          }
+        }
+      }
+    }
+    return bands;
+  }
 
-    int detInverse = -1;
-    for (int i = 1; i < 26; ++i) {
-      if ((det * i) % 26 == 1) {
-        detInverse = i;
-        break;
+  /**
+   * @brief Проверка длины и символов уже подготовленного текста
+   * @param data Текст
+   * @throw std::invalid_argument Если длина не кратна размеру матрицы или
+   * есть символы вне алфавита
+   */
+  void checkPrepared(std::span<const char> data) const {
+    if (data.size() % matrixSize != 0) {
+      throw std::invalid_argument(
+          "Длина текста должна быть кратна размеру матрицы");
+    }
+    for (char c : data) {
+      if (indexOf(c) < 0) {
+        throw std::invalid_argument("Текст содержит символы вне алфавита");
       }
     }
-    if (detInverse == -1) {
-      throw std::runtime_error("Матрица необратима");
+  }
+
+  /**
+   * @brief Умножение каждого блока текста на матрицу на месте
+   * @param matrix Матрица ключа или обратная матрица
+   * @param digraphs Таблица биграмм той же матрицы (только для 2x2)
+   * @param bands Ленточные веса той же матрицы (пусто, если SIMD недоступен)
+   * @param data Текст из символов алфавита
+   * @param size Длина текста, кратная размеру матрицы
+   * @details Для 2x2 используется таблица биграмм. Для больших матриц при
+   *          наличии AVX2 текст обрабатывается тайлами как матрица n x (len/n),
+   *          умножаемая на ключ целиком; остаток тайла считается поблочно.
+   *          Рабочие буферы тайла хранятся в потоке и переиспользуются
+   */
+  void applyMatrix(const std::vector<int> &matrix,
+                   const std::vector<uint16_t> &digraphs,
+                   const std::vector<int16_t> &bands, char *data,
+                   size_t size) const {
+    int n = matrixSize;
+    if (n == 2) {
+      int m = reducer.get();
+      for (size_t i = 0; i < size; i += 2) {
+        uint16_t pair = digraphs[indexOf(data[i]) * m + indexOf(data[i + 1])];
+        data[i] = static_cast<char>(pair & 0xFF);
+        data[i + 1] = static_cast<char>(pair >> 8);
+      }
+      return;
+    }
+
+    // Индексы текущего тайла с запасом в n-1 элемент слева и n + 16 справа.
+    // Буферы принадлежат потоку и только растут, поэтому повторные вызовы
+    // (в том числе для каждого блока HillStream) не выделяют память
+    thread_local std::vector<int16_t> buffer;
+    thread_local std::vector<unsigned char> out;
+    size_t tile = bands.empty() ? n : tileSymbols / n * n;
+    size_t need = (n - 1) + tile + n + 16;
+    if (buffer.size() < need) {
+      buffer.resize(need);
+    }
+    if (out.size() < tile) {
+      out.resize(tile);
     }
+    std::fill_n(buffer.begin(), n - 1, 0);
+    std::fill(buffer.begin() + (n - 1) + tile, buffer.begin() + need, 0);
+    int16_t *q = buffer.data() + (n - 1);
 
-    inverseMatrix = {{mod26(keyMatrix[1][1] * detInverse),
-                      mod26(-keyMatrix[0][1] * detInverse)},
-                     {mod26(-keyMatrix[1][0] * detInverse),
-                      mod26(keyMatrix[0][0] * detInverse)}};
+    for (size_t start = 0; start < size; start += tile) {
+      size_t len = std::min(tile, size - start);
+      char *chunk = data + start;
+      for (size_t x = 0; x < len; ++x) {
+        q[x] = static_cast<int16_t>(indexOf(chunk[x]));
+      }
+
+      size_t done = 0;
+#ifdef HILL_AVX2_KERNEL
+      if (!bands.empty()) {
+        done = len / 16 * 16;
+        hillBandKernelAvx2(q, bands.data(), n, bandPhases, done, reducer.get(),
+                           out.data());
+        for (size_t x = 0; x < done; ++x) {
+          chunk[x] = alphabet[out[x]];
+        }
+      }
+#endif
+      for (size_t x = done; x < len; ++x) {
+        size_t blockStart = x / n * n;
+        int r = x - blockStart;
+        uint32_t sum = 0;
+        for (int j = 0; j < n; ++j) {
+          sum += matrix[r * n + j] * q[blockStart + j];
+        }
+        chunk[x] = alphabet[reducer.reduce(sum)];
+      }
+    }
   }
 
   /**
-   * @brief Подготовка текста для шифрования/дешифрования
-   * @param text Исходный текст
-   * @return Обработанный текст (только буквы в нижнем регистре, дополненные 'x'
-   * при необходимости)
+   * @brief Наибольшая длина результата (см. CipherBase)
+   * @param inputSize Длина входа
+   * @param direction Направление
+   * @return Для шифрования - длина, округлённая вверх до кратной размеру
+   * матрицы (дополнение), для расшифрования - длина входа
    */
-  std::string processText(const std::string &text) {
-    std::string result;
-    for (char c : text) {
-      if (isalpha(c)) {
-        result += tolower(c);
-      }
+  size_t maxOutputImpl(size_t inputSize, Direction direction) const {
+    if (direction == Direction::Decrypt) {
+      return inputSize;
     }
-    while (result.size() % matrixSize != 0) {
-      result += 'x';
+    return (inputSize + matrixSize - 1) / matrixSize * matrixSize;
+  }
+
+  /**
+   * @brief Ядро шифра (см. CipherBase)
+   * @param input Вход
+   * @param output Выход не короче maxOutputImpl (может начинаться с input)
+   * @param direction Направление
+   * @return Длина результата
+   * @throw std::invalid_argument При расшифровании текста некратной длины или
+   * с символами вне алфавита
+   * @details Шифрование подготавливает текст и дополняет последний блок, как
+   *          encrypt; расшифрование строгое, как decrypt
+   */
+  size_t transformImpl(std::span<const char> input, std::span<char> output,
+                       Direction direction, size_t) const {
+    std::memmove(output.data(), input.data(), input.size());
+    if (direction == Direction::Decrypt) {
+      decryptInPlace(output.first(input.size()));
+      return input.size();
     }
-    return result;
+    size_t length = normalizeInPlace(output.first(input.size()));
+    size_t padded = maxOutputImpl(length, direction);
+    std::fill(output.begin() + length, output.begin() + padded, padSymbol);
+    encryptInPlace(output.first(padded));
+    return padded;
   }
 
 public:
+  static constexpr bool preservesLength = false; ///< Дополнение блока
+
   /**
    * @brief Конструктор класса HillCipher
-   * @param key Матрица ключа 2x2
-   * @throw std::invalid_argument Если ключ не является матрицей 2x2
+   * @param key Квадратная матрица ключа
+   * @param alph Алфавит из уникальных однобайтовых символов (от 2 до 256)
+   * @throw std::invalid_argument Если ключ не является квадратной матрицей
+   * или алфавит некорректен
+   * @throw std::runtime_error Если матрица необратима по модулю длины алфавита
    */
-  HillCipher(const std::vector<std::vector<int>> &key) : keyMatrix(key) {
+  HillCipher(const std::vector<std::vector<int>> &key,
+             const std::string &alph = "abcdefghijklmnopqrstuvwxyz")
+      : alphabet(alph), reducer(alph.empty() ? 1 : alph.size()) {
+    if (alphabet.size() < 2 || alphabet.size() > 256) {
+      throw std::invalid_argument(
+          "Алфавит должен содержать от 2 до 256 символов");
+    }
+    symbolIndex.fill(-1);
+    for (size_t i = 0; i < alphabet.size(); ++i) {
+      int &slot = symbolIndex[static_cast<unsigned char>(alphabet[i])];
+      if (slot != -1) {
+        throw std::invalid_argument("Алфавит содержит повторяющиеся символы");
+      }
+      slot = i;
+    }
+    padSymbol = indexOf('x') >= 0 ? 'x' : alphabet.back();
+
+    int m = alphabet.size();
     matrixSize = key.size();
-    if (matrixSize != 2 || key[0].size() != 2) {
-      throw std::invalid_argument("Ключ должен быть матрицей 2x2");
+    if (matrixSize == 0) {
+      throw std::invalid_argument("Ключ должен быть квадратной матрицей");
+    }
+    keyMatrix.reserve(matrixSize * matrixSize);
+    for (const auto &row : key) {
+      if (static_cast<int>(row.size()) != matrixSize) {
+        throw std::invalid_argument("Ключ должен быть квадратной матрицей");
+      }
+      for (int value : row) {
+        keyMatrix.push_back((value % m + m) % m);
+      }
     }
     calculateInverse();
+    if (matrixSize == 2) {
+      encryptDigraphs = buildDigraphTable(keyMatrix);
+      decryptDigraphs = buildDigraphTable(inverseMatrix);
+    }
+#ifdef HILL_AVX2_KERNEL
+    // Суммы n произведений должны оставаться точными в float (< 2^24)
+    if (matrixSize > 2 && matrixSize <= 64 &&
+        matrixSize * (m - 1) * (m - 1) < (1 << 24) && hillCpuHasAvx2()) {
+      bandPhases = matrixSize / std::gcd(matrixSize, 16);
+      encryptBands = buildBandWeights(keyMatrix);
+      decryptBands = buildBandWeights(inverseMatrix);
+    }
+#endif
   }
 
   /**
-   * @brief Шифрование текста
-   * @param plaintext Исходный текст
-   * @return Зашифрованный текст
+   * @brief Размер блока (матрицы ключа)
+   * @return n
    */
-  std::string encrypt(const std::string &plaintext) {
-    std::string processed = processText(plaintext);
-    std::string ciphertext;
+  int blockSize() const { return matrixSize; }
 
-    for (size_t i = 0; i < processed.size(); i += matrixSize) {
-      int c1 = processed[i] - 'a';
-      int c2 = processed[i + 1] - 'a';
+  /**
+   * @brief Длина алфавита (модуль)
+   * @return m
+   */
+  int alphabetSize() const { return alphabet.size(); }
 
-      int e1 = mod26(keyMatrix[0][0] * c1 + keyMatrix[0][1] * c2);
-      int e2 = mod26(keyMatrix[1][0] * c1 + keyMatrix[1][1] * c2);
+  /**
+   * @brief Индекс символа в алфавите
+   * @param c Символ
+   * @return Индекс или -1, если символа нет в алфавите
+   */
+  int indexOf(char c) const {
+    return symbolIndex[static_cast<unsigned char>(c)];
+  }
 
-      ciphertext += static_cast<char>(e1 + 'a');
-      ciphertext += static_cast<char>(e2 + 'a');
+  /**
+   * @brief Символ алфавита по индексу
+   * @param index Индекс от 0 до m-1
+   * @return Символ алфавита
+   */
+  char symbolAt(int index) const { return alphabet[index]; }
+
+  /**
+   * @brief Символ дополнения последнего блока
+   * @return Текущий символ дополнения
+   */
+  char getPadSymbol() const { return padSymbol; }
+
+  /**
+   * @brief Задание символа дополнения последнего блока
+   * @param symbol Символ алфавита (по умолчанию 'x' или последний символ)
+   * @throw std::invalid_argument Если символа нет в алфавите
+   */
+  void setPadSymbol(char symbol) {
+    if (indexOf(symbol) < 0) {
+      throw std::invalid_argument("Символ дополнения должен входить в алфавит");
+    }
+    padSymbol = symbol;
+  }
+
+  /**
+   * @brief Подготовка текста на месте
+   * @param data Исходный текст
+   * @return Новая длина: в начале data остаются только символы алфавита
+   * (при отсутствии символа в алфавите пробуется его строчный вариант)
+   */
+  size_t normalizeInPlace(std::span<char> data) const {
+    size_t length = 0;
+    for (char c : data) {
+      if (indexOf(c) >= 0) {
+        data[length++] = c;
+      } else if (indexOf(static_cast<char>(tolower(c))) >= 0) {
+        data[length++] = static_cast<char>(tolower(c));
+      }
     }
-    return ciphertext;
+    return length;
+  }
+
+  /**
+   * @brief Шифрование подготовленного текста на месте, без выделения памяти
+   * под текст
+   * @param data Символы алфавита, длина кратна размеру матрицы
+   * @throw std::invalid_argument Если длина или символы некорректны
+   */
+  void encryptInPlace(std::span<char> data) const {
+    checkPrepared(data);
+    applyMatrix(keyMatrix, encryptDigraphs, encryptBands, data.data(),
+                data.size());
+  }
+
+  /**
+   * @brief Дешифрование текста на месте, без выделения памяти под текст
+   * @param data Символы алфавита, длина кратна размеру матрицы
+   * @throw std::invalid_argument Если длина или символы некорректны
+   */
+  void decryptInPlace(std::span<char> data) const {
+    checkPrepared(data);
+    applyMatrix(inverseMatrix, decryptDigraphs, decryptBands, data.data(),
+                data.size());
+  }
+
+  /**
+   * @brief Шифрование текста
+   * @param plaintext Исходный текст
+   * @return Зашифрованный текст (символы вне алфавита отбрасываются, последний
+   * блок дополняется символом дополнения)
+   */
+  std::string encrypt(const std::string &plaintext) const {
+    return transform(plaintext, Direction::Encrypt);
   }
 
   /**
    * @brief Дешифрование текста
    * @param ciphertext Зашифрованный текст
    * @return Расшифрованный текст
+   * @throw std::invalid_argument Если длина текста не кратна размеру матрицы
+   * или текст содержит символы вне алфавита
    */
-  std::string decrypt(const std::string &ciphertext) {
-    std::string plaintext;
+  std::string decrypt(const std::string &ciphertext) const {
+    return transform(ciphertext, Direction::Decrypt);
+  }
+};
 
-    for (size_t i = 0; i < ciphertext.size(); i += matrixSize) {
-      int c1 = ciphertext[i] - 'a';
-      int c2 = ciphertext[i + 1] - 'a';
+/**
+ * @brief Способ дополнения последнего блока при потоковой обработке
+ */
+enum class HillPadding {
+  Symbol, ///< Символом дополнения до кратной длины; при расшифровании не
+          ///< снимается (как в HillCipher::encrypt)
+  Length  ///< В стиле PKCS#7: k от 1 до n символов alphabet[k], снимается
+          ///< при расшифровании
+};
 
-      int p1 = mod26(inverseMatrix[0][0] * c1 + inverseMatrix[0][1] * c2);
-      int p2 = mod26(inverseMatrix[1][0] * c1 + inverseMatrix[1][1] * c2);
+/**
+ * @class HillStream
+ * @brief Потоковое шифрование/дешифрование Хилла по частям произвольной длины
+ *
+ * Части должны состоять из подготовленных символов алфавита (см.
+ * HillCipher::normalizeInPlace). Целые блоки обрабатываются на месте прямо в
+ * переданной части, неполный блок на стыке частей переносится во внутренний
+ * буфер из n символов. Дополнение применяется только в finish().
+ */
+class HillStream {
+  const HillCipher &cipher; ///< Шифр (должен жить дольше потока)
+  bool decrypting;          ///< true - дешифрование
+  HillPadding padding;      ///< Способ дополнения
+  std::vector<char> carry;  ///< Неполный (или удерживаемый) блок
+  size_t carried = 0;       ///< Число символов в carry
 
-      plaintext += static_cast<char>(p1 + 'a');
-      plaintext += static_cast<char>(p2 + 'a');
+  /**
+   * @brief Нужно ли удерживать последний целый блок до finish()
+   * @return true при расшифровании с дополнением Length
+   */
+  bool holdLast() const {
+    return decrypting && padding == HillPadding::Length;
+  }
+
+  /**
+   * @brief Обработка целых блоков на месте
+   * @param data Символы, длина кратна n
+   */
+  void transform(std::span<char> data) const {
+    if (decrypting) {
+      cipher.decryptInPlace(data);
+    } else {
+      cipher.encryptInPlace(data);
+    }
+  }
+
+public:
+  /**
+   * @brief Конструктор потока
+   * @param c Шифр Хилла
+   * @param decrypt true - дешифрование, false - шифрование
+   * @param mode Способ дополнения
+   * @throw std::invalid_argument Если для Length размер блока не меньше
+   * длины алфавита (длину дополнения нельзя записать символом)
+   */
+  HillStream(const HillCipher &c, bool decrypt,
+             HillPadding mode = HillPadding::Symbol)
+      : cipher(c), decrypting(decrypt), padding(mode),
+        carry(c.blockSize()) {
+    if (mode == HillPadding::Length && c.blockSize() >= c.alphabetSize()) {
+      throw std::invalid_argument(
+          "Длина дополнения не помещается в символ алфавита");
+    }
+  }
+
+  /**
+   * @brief Обработка очередной части потока
+   * @param chunk Часть из подготовленных символов; изменяется на месте
+   * @param sink Вызывается с каждым готовым фрагментом (std::span<char>)
+   */
+  template <class Sink> void update(std::span<char> chunk, Sink &&sink) {
+    size_t n = carry.size();
+    size_t pos = 0;
+    if (carried > 0) {
+      size_t take = std::min(n - carried, chunk.size());
+      std::copy(chunk.begin(), chunk.begin() + take, carry.begin() + carried);
+      carried += take;
+      pos = take;
+      if (carried < n || (holdLast() && pos == chunk.size())) {
+        return;
+      }
+      transform(carry);
+      sink(std::span<char>(carry));
+      carried = 0;
+    }
+
+    size_t rest = chunk.size() - pos;
+    size_t full = rest / n * n;
+    if (holdLast() && full == rest && full > 0) {
+      full -= n;
+    }
+    if (full > 0) {
+      std::span<char> blocks = chunk.subspan(pos, full);
+      transform(blocks);
+      sink(blocks);
+    }
+    std::copy(chunk.begin() + pos + full, chunk.end(), carry.begin());
+    carried = rest - full;
+  }
+
+  /**
+   * @brief Завершение потока: дополнение или снятие дополнения
+   * @param sink Вызывается с последним фрагментом, если он есть
+   * @throw std::invalid_argument Если при расшифровании длина потока не
+   * кратна n или дополнение некорректно
+   */
+  template <class Sink> void finish(Sink &&sink) {
+    size_t n = carry.size();
+    size_t length = carried;
+    carried = 0;
+    if (!decrypting) {
+      if (padding == HillPadding::Symbol) {
+        if (length == 0) {
+          return;
+        }
+        std::fill(carry.begin() + length, carry.end(), cipher.getPadSymbol());
+      } else {
+        size_t k = n - length;
+        std::fill(carry.begin() + length, carry.end(), cipher.symbolAt(k));
+      }
+      transform(carry);
+      sink(std::span<char>(carry));
+      return;
+    }
+
+    if (padding == HillPadding::Symbol) {
+      if (length != 0) {
+        throw std::invalid_argument(
+            "Длина шифртекста должна быть кратна размеру матрицы");
+      }
+      return;
+    }
+    if (length != n) {
+      throw std::invalid_argument(
+          "Длина шифртекста должна быть кратна размеру матрицы");
+    }
+    transform(carry);
+    int k = cipher.indexOf(carry[n - 1]);
+    if (k < 1 || k > static_cast<int>(n)) {
+      throw std::invalid_argument("Некорректное дополнение");
+    }
+    if (k < static_cast<int>(n)) {
+      sink(std::span<char>(carry.data(), n - k));
     }
-    return plaintext;
   }
 };
 
-#endif // HILL_CIPHER_H
\ No newline at end of file
+#endif // HILL_CIPHER_H
@@ -0,0 +1,496 @@
+/**
+ * @file hill_attack.h
+ * @brief Криптоанализ шифра Хилла
+ * @details Восстановление ключа шифра Хилла по известным парам открытого и
+ *          зашифрованного текста, а также атака только по шифртексту с
+ *          построчным перебором обратной матрицы
+ */
+
+#ifndef HILL_ATTACK_H
+#define HILL_ATTACK_H
+
+#include "Hill.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Перевод текста в индексы символов алфавита
+ * @param text Текст из символов алфавита
+ * @param alphabet Алфавит
+ * @return Индексы символов текста
+ * @throw std::invalid_argument Если в тексте есть символ вне алфавита
+ */
+inline std::vector<int> hillTextToIndices(const std::string &text,
+                                          const std::string &alphabet) {
+  std::vector<int> index(256, -1);
+  for (size_t i = 0; i < alphabet.size(); ++i) {
+    index[static_cast<unsigned char>(alphabet[i])] = i;
+  }
+  std::vector<int> result(text.size());
+  for (size_t i = 0; i < text.size(); ++i) {
+    result[i] = index[static_cast<unsigned char>(text[i])];
+    if (result[i] < 0) {
+      throw std::invalid_argument("Текст содержит символы вне алфавита");
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Восстановление ключа Хилла по известному открытому тексту
+ * @param plaintext Открытый текст (только символы алфавита)
+ * @param ciphertext Соответствующий шифртекст той же длины
+ * @param n Размер матрицы ключа
+ * @param alphabet Алфавит, по длине которого берётся модуль
+ * @param threads Число потоков перебора (0 - по числу ядер)
+ * @return Матрица ключа n x n
+ * @throw std::invalid_argument Если тексты разной длины, короче n*n или
+ * содержат символы вне алфавита
+ * @throw std::runtime_error Если ни один набор блоков не даёт ключ,
+ * согласованный со всеми данными
+ * @details Ключ удовлетворяет C = K * P (mod m), где столбцы P и C - блоки
+ *          текстов. Выбираются n блоков открытого текста, образующих
+ *          обратимую матрицу P, и K = C * P^(-1) находится методом
+ *          Гаусса-Жордана. Найденный ключ проверяется на всех остальных
+ *          блоках. Сначала пробуются первые n блоков; если они не подходят,
+ *          сочетания из первых различных блоков перебираются параллельно
+ */
+inline std::vector<std::vector<int>>
+recoverHillKey(const std::string &plaintext, const std::string &ciphertext,
+               int n,
+               const std::string &alphabet = "abcdefghijklmnopqrstuvwxyz",
+               unsigned threads = 0) {
+  if (n <= 0 || plaintext.size() != ciphertext.size() ||
+      plaintext.size() < static_cast<size_t>(n * n)) {
+    throw std::invalid_argument(
+        "Нужны тексты одинаковой длины не короче n*n символов");
+  }
+  int m = alphabet.size();
+  std::vector<int> p = hillTextToIndices(plaintext, alphabet);
+  std::vector<int> c = hillTextToIndices(ciphertext, alphabet);
+  std::vector<int> units = buildUnitInverseTable(m);
+  size_t blocks = p.size() / n;
+
+  // Проверка ключа на всех блоках
+  auto consistent = [&](const std::vector<int> &key) {
+    for (size_t b = 0; b < blocks; ++b) {
+      for (int r = 0; r < n; ++r) {
+        int sum = 0;
+        for (int j = 0; j < n; ++j) {
+          sum = (sum + key[r * n + j] * p[b * n + j]) % m;
+        }
+        if (sum != c[b * n + r]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  // Решение C = K * P для выбранных блоков
+  auto solve = [&](const std::vector<size_t> &chosen, std::vector<int> &key) {
+    std::vector<int> pm(n * n), pinv;
+    for (int k = 0; k < n; ++k) {
+      for (int j = 0; j < n; ++j) {
+        pm[j * n + k] = p[chosen[k] * n + j];
+      }
+    }
+    if (!invertMatrixMod(pm, n, m, units, pinv)) {
+      return false;
+    }
+    key.assign(n * n, 0);
+    for (int r = 0; r < n; ++r) {
+      for (int col = 0; col < n; ++col) {
+        int sum = 0;
+        for (int k = 0; k < n; ++k) {
+          sum = (sum + c[chosen[k] * n + r] * pinv[k * n + col]) % m;
+        }
+        key[r * n + col] = sum;
+      }
+    }
+    return consistent(key);
+  };
+
+  auto toMatrix = [n](const std::vector<int> &key) {
+    std::vector<std::vector<int>> result(n, std::vector<int>(n));
+    for (int r = 0; r < n; ++r) {
+      for (int col = 0; col < n; ++col) {
+        result[r][col] = key[r * n + col];
+      }
+    }
+    return result;
+  };
+
+  std::vector<size_t> first(n);
+  for (int k = 0; k < n; ++k) {
+    first[k] = k;
+  }
+  std::vector<int> key;
+  if (solve(first, key)) {
+    return toMatrix(key);
+  }
+
+  // Кандидаты - первые различные блоки открытого текста
+  const size_t maxCandidates = 48;
+  const size_t maxCombinations = 1 << 20;
+  std::vector<size_t> candidates;
+  for (size_t b = 0; b < blocks && candidates.size() < maxCandidates; ++b) {
+    bool repeated = false;
+    for (size_t other : candidates) {
+      if (std::equal(p.begin() + b * n, p.begin() + (b + 1) * n,
+                     p.begin() + other * n)) {
+        repeated = true;
+        break;
+      }
+    }
+    if (!repeated) {
+      candidates.push_back(b);
+    }
+  }
+  if (candidates.size() < static_cast<size_t>(n)) {
+    throw std::runtime_error("Не удалось восстановить ключ");
+  }
+
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::atomic<bool> found(false);
+  std::mutex resultMutex;
+  std::vector<int> result;
+
+  // Поток t проверяет сочетания с номерами t, t + threads, ...
+  auto worker = [&](unsigned t) {
+    std::vector<size_t> combo(n), chosen(n);
+    for (int k = 0; k < n; ++k) {
+      combo[k] = k;
+    }
+    std::vector<int> local;
+    size_t total = candidates.size();
+    for (size_t rank = 0; rank < maxCombinations && !found.load(); ++rank) {
+      if (rank % threads == t) {
+        for (int k = 0; k < n; ++k) {
+          chosen[k] = candidates[combo[k]];
+        }
+        if (solve(chosen, local)) {
+          std::lock_guard<std::mutex> lock(resultMutex);
+          if (!found.exchange(true)) {
+            result = local;
+          }
+          return;
+        }
+      }
+      int k = n - 1;
+      while (k >= 0 && combo[k] == total - n + k) {
+        --k;
+      }
+      if (k < 0) {
+        return;
+      }
+      ++combo[k];
+      for (int j = k + 1; j < n; ++j) {
+        combo[j] = combo[j - 1] + 1;
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back(worker, t);
+  }
+  for (auto &th : pool) {
+    th.join();
+  }
+
+  if (!found.load()) {
+    throw std::runtime_error("Не удалось восстановить ключ");
+  }
+  return toMatrix(result);
+}
+
+/**
+ * @class QuadgramScorer
+ * @brief Оценка правдоподобия текста по статистике языка
+ *
+ * Частоты одиночных символов и четырёхграмм берутся из эталонного текста на
+ * том же языке, поэтому модель подходит для любого алфавита. Оценка - сумма
+ * логарифмов вероятностей, ненаблюдавшиеся события получают малую
+ * вероятность.
+ */
+class QuadgramScorer {
+  int m;                        ///< Длина алфавита
+  std::vector<double> unigrams; ///< P(символ)
+  std::vector<float> quadgrams; ///< log P(четырёхграмма), m^4 элементов
+
+public:
+  /**
+   * @brief Конструктор, собирающий статистику по эталонному тексту
+   * @param reference Эталонный текст (символы вне алфавита пропускаются,
+   * заглавные буквы приводятся к строчным)
+   * @param alphabet Алфавит не длиннее 64 символов
+   * @throw std::invalid_argument Если алфавит слишком длинный или в эталоне
+   * меньше четырёх символов алфавита
+   */
+  QuadgramScorer(const std::string &reference, const std::string &alphabet)
+      : m(alphabet.size()) {
+    if (m < 2 || m > 64) {
+      throw std::invalid_argument(
+          "Для статистики нужен алфавит от 2 до 64 символов");
+    }
+    std::vector<int> index(256, -1);
+    for (int i = 0; i < m; ++i) {
+      index[static_cast<unsigned char>(alphabet[i])] = i;
+    }
+    std::vector<int> text;
+    for (char ch : reference) {
+      int i = index[static_cast<unsigned char>(ch)];
+      if (i < 0) {
+        i = index[static_cast<unsigned char>(tolower(ch))];
+      }
+      if (i >= 0) {
+        text.push_back(i);
+      }
+    }
+    if (text.size() < 4) {
+      throw std::invalid_argument("Эталонный текст слишком короткий");
+    }
+
+    std::vector<double> counts(m, 1.0);
+    for (int i : text) {
+      counts[i] += 1.0;
+    }
+    unigrams.resize(m);
+    for (int i = 0; i < m; ++i) {
+      unigrams[i] = counts[i] / (text.size() + m);
+    }
+
+    size_t total = text.size() - 3;
+    quadgrams.assign(static_cast<size_t>(m) * m * m * m, 0.0f);
+    for (size_t i = 0; i < total; ++i) {
+      quadgrams[((text[i] * m + text[i + 1]) * m + text[i + 2]) * m +
+                text[i + 3]] += 1.0f;
+    }
+    float floor = std::log(0.01 / total);
+    for (float &q : quadgrams) {
+      q = q > 0 ? std::log(q / total) : floor;
+    }
+  }
+
+  /**
+   * @brief Частота символа в эталонном тексте
+   * @param i Индекс символа
+   * @return P(i)
+   */
+  double frequency(int i) const { return unigrams[i]; }
+
+  /**
+   * @brief Оценка последовательности индексов по четырёхграммам
+   * @param text Индексы символов
+   * @return Сумма логарифмов вероятностей всех четырёхграмм текста
+   */
+  double score(const std::vector<int> &text) const {
+    double result = 0;
+    for (size_t i = 0; i + 3 < text.size(); ++i) {
+      result += quadgrams[((text[i] * m + text[i + 1]) * m + text[i + 2]) * m +
+                          text[i + 3]];
+    }
+    return result;
+  }
+};
+
+/**
+ * @brief Результат атаки на шифр Хилла только по шифртексту
+ */
+struct HillAttackResult {
+  std::vector<std::vector<int>> key; ///< Найденная матрица ключа
+  std::string plaintext;             ///< Расшифрованный ею текст
+  double score;                      ///< Оценка текста по четырёхграммам
+};
+
+/**
+ * @brief Атака на шифр Хилла только по шифртексту с построчным перебором
+ * @param ciphertext Шифртекст (только символы алфавита, длина кратна n)
+ * @param n Размер матрицы ключа
+ * @param scorer Статистика языка открытого текста
+ * @param alphabet Алфавит шифра
+ * @param topRows Сколько лучших строк-кандидатов комбинировать в матрицы
+ * @param threads Число потоков перебора строк (0 - по числу ядер)
+ * @return Ключ с наилучшей оценкой расшифрованного текста
+ * @throw std::invalid_argument Если шифртекст пуст, длина не кратна n или
+ * есть символы вне алфавита
+ * @throw std::runtime_error Если из лучших строк не собирается обратимая
+ * матрица
+ * @details Строка i обратной матрицы D определяет только каждый n-й символ
+ *          открытого текста (позиции i, i+n, ...), поэтому каждая из m^n
+ *          строк оценивается отдельно по критерию хи-квадрат для частот
+ *          получаемых символов - всего n*m^n вместо m^(n*n) вариантов.
+ *          Строки перебираются в лексикографическом порядке с пересчётом
+ *          символов сложением, работа делится между потоками по первой
+ *          координате. Затем из topRows лучших строк собираются все
+ *          обратимые матрицы D, открытый текст каждой оценивается по
+ *          четырёхграммам, и ключом становится D^(-1) лучшей из них
+ */
+inline HillAttackResult
+breakHillCiphertextOnly(const std::string &ciphertext, int n,
+                        const QuadgramScorer &scorer,
+                        const std::string &alphabet =
+                            "abcdefghijklmnopqrstuvwxyz",
+                        int topRows = 8, unsigned threads = 0) {
+  if (n <= 0 || ciphertext.empty() || ciphertext.size() % n != 0) {
+    throw std::invalid_argument(
+        "Длина шифртекста должна быть кратна размеру матрицы");
+  }
+  int m = alphabet.size();
+  std::vector<int> c = hillTextToIndices(ciphertext, alphabet);
+  size_t blocks = c.size() / n;
+  long long rowCount = 1;
+  for (int i = 0; i < n; ++i) {
+    rowCount *= m;
+  }
+  topRows = std::max(topRows, n);
+
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::min<unsigned>(threads, m);
+
+  using Candidate = std::pair<double, std::vector<int>>;
+  auto better = [](const Candidate &a, const Candidate &b) {
+    return a.first > b.first;
+  };
+  std::vector<std::vector<Candidate>> best(threads);
+
+  // Поток t перебирает строки с первой координатой t, t + threads, ...
+  auto worker = [&](unsigned t) {
+    std::vector<Candidate> &top = best[t];
+    std::vector<int> row(n), symbols(blocks);
+    std::vector<int> histogram(m);
+    long long perFirst = rowCount / m;
+    for (int first = t; first < m; first += threads) {
+      std::fill(row.begin(), row.end(), 0);
+      row[0] = first;
+      for (size_t b = 0; b < blocks; ++b) {
+        symbols[b] = first * c[b * n] % m;
+      }
+      for (long long step = 0; step < perFirst; ++step) {
+        std::fill(histogram.begin(), histogram.end(), 0);
+        for (int s : symbols) {
+          ++histogram[s];
+        }
+        // Минус хи-квадрат: вырожденные строки (все символы одинаковы)
+        // получают низкую оценку
+        double fitness = 0;
+        for (int s = 0; s < m; ++s) {
+          double expected = blocks * scorer.frequency(s);
+          double diff = histogram[s] - expected;
+          fitness -= diff * diff / expected;
+        }
+        if (static_cast<int>(top.size()) < topRows ||
+            fitness > top.back().first) {
+          Candidate candidate(fitness, row);
+          top.insert(std::upper_bound(top.begin(), top.end(), candidate,
+                                      better),
+                     candidate);
+          if (static_cast<int>(top.size()) > topRows) {
+            top.pop_back();
+          }
+        }
+
+        // Следующая строка: увеличение младших координат с переносом
+        for (int j = n - 1; j > 0; --j) {
+          // Переход m-1 -> 0 тоже прибавляет единицу по модулю m
+          for (size_t b = 0; b < blocks; ++b) {
+            int s = symbols[b] + c[b * n + j];
+            symbols[b] = s >= m ? s - m : s;
+          }
+          if (++row[j] < m) {
+            break;
+          }
+          row[j] = 0;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back(worker, t);
+  }
+  for (auto &th : pool) {
+    th.join();
+  }
+
+  std::vector<Candidate> rows;
+  for (auto &top : best) {
+    rows.insert(rows.end(), top.begin(), top.end());
+  }
+  std::sort(rows.begin(), rows.end(), better);
+  rows.resize(std::min<size_t>(rows.size(), topRows));
+
+  // Перебор упорядоченных наборов из n различных строк
+  std::vector<int> units = buildUnitInverseTable(m);
+  HillAttackResult result{{}, "", -INFINITY};
+  std::vector<int> chosen(n), matrix(n * n), inverse, plain(c.size());
+  std::vector<bool> used(rows.size(), false);
+  auto evaluate = [&]() {
+    for (int i = 0; i < n; ++i) {
+      std::copy(rows[chosen[i]].second.begin(), rows[chosen[i]].second.end(),
+                matrix.begin() + i * n);
+    }
+    if (!invertMatrixMod(matrix, n, m, units, inverse)) {
+      return;
+    }
+    for (size_t b = 0; b < blocks; ++b) {
+      for (int r = 0; r < n; ++r) {
+        int sum = 0;
+        for (int j = 0; j < n; ++j) {
+          sum += matrix[r * n + j] * c[b * n + j];
+        }
+        plain[b * n + r] = sum % m;
+      }
+    }
+    double score = scorer.score(plain);
+    if (score > result.score) {
+      result.score = score;
+      result.key.assign(n, std::vector<int>(n));
+      for (int r = 0; r < n; ++r) {
+        for (int j = 0; j < n; ++j) {
+          result.key[r][j] = inverse[r * n + j];
+        }
+      }
+      result.plaintext.resize(plain.size());
+      for (size_t i = 0; i < plain.size(); ++i) {
+        result.plaintext[i] = alphabet[plain[i]];
+      }
+    }
+  };
+  auto place = [&](auto &self, int position) -> void {
+    if (position == n) {
+      evaluate();
+      return;
+    }
+    for (size_t r = 0; r < rows.size(); ++r) {
+      if (!used[r]) {
+        used[r] = true;
+        chosen[position] = r;
+        self(self, position + 1);
+        used[r] = false;
+      }
+    }
+  };
+  place(place, 0);
+
+  if (result.key.empty()) {
+    throw std::runtime_error("Не удалось подобрать обратимую матрицу");
+  }
+  return result;
+}
+
+#endif // HILL_ATTACK_H
@@ -0,0 +1,142 @@
+/**
+ * @file mappedfile.h
+ * @brief Отображение файлов в память (POSIX mmap)
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @class MappedFile
+ * @brief Файл, отображённый в память (владеет дескриптором и отображением)
+ */
+class MappedFile {
+  int fd = -1;                   ///< Дескриптор файла
+  unsigned char *data = nullptr; ///< Начало отображения
+  size_t length = 0;             ///< Длина отображения
+
+  /**
+   * @brief Исключение с описанием системной ошибки
+   * @param what Что не удалось сделать
+   * @param path Путь к файлу
+   */
+  [[noreturn]] static void fail(const std::string &what,
+                                const std::string &path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+  }
+
+public:
+  /**
+   * @brief Отображение существующего файла только для чтения
+   * @param path Путь к файлу
+   * @param populate Заранее подгрузить страницы (MAP_POPULATE)
+   * @throw std::runtime_error При ошибке открытия или отображения
+   */
+  MappedFile(const std::string &path, bool populate) {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      fail("Не удалось открыть файл", path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      fail("Не удалось получить размер файла", path);
+    }
+    map(path, st.st_size, PROT_READ, populate);
+  }
+
+  /**
+   * @brief Создание (перезапись) файла заданного размера для записи
+   * @param path Путь к файлу
+   * @param size Размер файла
+   * @param populate Заранее подгрузить страницы (MAP_POPULATE)
+   * @throw std::runtime_error При ошибке создания или отображения
+   */
+  MappedFile(const std::string &path, size_t size, bool populate) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+      fail("Не удалось создать файл", path);
+    }
+    if (ftruncate(fd, size) != 0) {
+      close(fd);
+      fail("Не удалось задать размер файла", path);
+    }
+    map(path, size, PROT_READ | PROT_WRITE, populate);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile() {
+    if (data != nullptr) {
+      munmap(data, length);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+
+  /**
+   * @brief Начало данных
+   * @return Указатель на отображение (nullptr для пустого файла)
+   */
+  unsigned char *bytes() const { return data; }
+
+  /**
+   * @brief Размер файла
+   * @return Число байт
+   */
+  size_t size() const { return length; }
+
+  /**
+   * @brief Указывает ли путь на этот же файл
+   * @param path Путь (может не существовать)
+   * @return true, если путь ведёт к тому же устройству и inode
+   */
+  bool sameFile(const std::string &path) const {
+    struct stat mine, other;
+    return fstat(fd, &mine) == 0 && stat(path.c_str(), &other) == 0 &&
+           mine.st_dev == other.st_dev && mine.st_ino == other.st_ino;
+  }
+
+private:
+  /**
+   * @brief Отображение открытого файла в память
+   * @param path Путь (для сообщения об ошибке)
+   * @param size Размер
+   * @param protection Права доступа к страницам
+   * @param populate Заранее подгрузить страницы
+   */
+  void map(const std::string &path, size_t size, int protection,
+           bool populate) {
+    length = size;
+    if (length == 0) {
+      return;
+    }
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate) {
+      flags |= MAP_POPULATE;
+    }
+#endif
+    void *p = mmap(nullptr, length, protection, flags, fd, 0);
+    if (p == MAP_FAILED) {
+      close(fd);
+      fd = -1;
+      fail("Не удалось отобразить файл", path);
+    }
+    data = static_cast<unsigned char *>(p);
+    madvise(data, length, MADV_SEQUENTIAL);
+  }
+};
+
+#endif // MAPPED_FILE_H
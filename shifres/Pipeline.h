@@ -0,0 +1,187 @@
+/**
+ * @file pipeline.h
+ * @brief Цепочка шифров, сохраняющих длину, за один проход по памяти
+ * @details Последовательное применение шифров (например, простая замена ->
+ *          Виженер -> Вернам) через их методы стоит полного прохода по тексту
+ *          и новой строки на каждую ступень. Цепочка сводит подряд идущие
+ *          побайтовые замены в одну таблицу при построении, а ступени,
+ *          зависящие от позиции, выполняет по тайлам, помещающимся в кэш:
+ *          тайл проходит все ступени, пока он в L1, и записывается в выход
+ *          один раз
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "Cipher.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+/// Размер тайла, который проходит все ступени цепочки подряд
+constexpr size_t pipelineTileSize = size_t(16) << 10;
+
+/**
+ * @brief Заменяет ли шифр каждый байт независимо от позиции
+ * @tparam Impl Шифр с CipherBase
+ * @details Такие шифры объявляют static constexpr bool mapsBytes = true;
+ *          их преобразование полностью задаётся таблицей из 256 байт
+ */
+template <class Impl>
+constexpr bool isByteMapCipher = requires { requires Impl::mapsBytes; };
+
+/**
+ * @class CipherPipeline
+ * @brief Композиция шифров, сохраняющих длину
+ *
+ * Цепочка сама является шифром (CipherBase): шифрование применяет ступени
+ * по порядку, расшифрование - обратные ступени в обратном порядке. Байт в
+ * позиции i потока обрабатывается каждой ступенью как байт в позиции i, так
+ * что результат совпадает с последовательным применением шифров.
+ */
+class CipherPipeline : public CipherBase<CipherPipeline> {
+  friend class CipherBase<CipherPipeline>;
+
+  /// Шаг выполнения: таблица замены (cipher пуст) или шифр с позицией
+  struct Step {
+    std::array<char, 256> table;          ///< Составная таблица замены
+    std::shared_ptr<const Cipher> cipher; ///< Шифр, зависящий от позиции
+    Direction direction;                  ///< Направление для cipher
+  };
+
+  std::vector<Step> encryptSteps; ///< Шаги шифрования по порядку
+  std::vector<Step> decryptSteps; ///< Шаги расшифрования по порядку
+
+  /**
+   * @brief Противоположное направление
+   * @param direction Направление
+   * @return Обратное направление
+   */
+  static Direction opposite(Direction direction) {
+    return direction == Direction::Encrypt ? Direction::Decrypt
+                                           : Direction::Encrypt;
+  }
+
+  /**
+   * @brief Таблица шифра, заменяющего байты независимо от позиции
+   * @param cipher Шифр
+   * @param direction Направление
+   * @return Образы всех 256 байт
+   */
+  template <class Impl>
+  static std::array<char, 256> byteTable(const Impl &cipher,
+                                         Direction direction) {
+    std::array<char, 256> table;
+    for (int c = 0; c < 256; ++c) {
+      table[c] = static_cast<char>(c);
+    }
+    cipher.transformInPlace(table, direction);
+    return table;
+  }
+
+  /**
+   * @brief Применение шага к участку тайла
+   * @param step Шаг
+   * @param input Вход
+   * @param output Выход той же длины (может совпадать с input)
+   * @param offset Позиция input[0] в потоке
+   */
+  static void apply(const Step &step, std::span<const char> input,
+                    std::span<char> output, size_t offset) {
+    if (step.cipher) {
+      step.cipher->transform(input, output, step.direction, offset);
+      return;
+    }
+    for (size_t i = 0; i < input.size(); ++i) {
+      output[i] = step.table[static_cast<unsigned char>(input[i])];
+    }
+  }
+
+  /**
+   * @brief Ядро шифра (см. CipherBase): все шаги потайлово
+   * @param input Вход
+   * @param output Выход не короче input (может совпадать с ним)
+   * @param direction Направление
+   * @param offset Позиция input[0] в потоке
+   * @return Длина результата
+   * @throw Исключения ступеней (например, символ вне алфавита Виженера)
+   */
+  size_t transformImpl(std::span<const char> input, std::span<char> output,
+                       Direction direction, size_t offset) const {
+    const std::vector<Step> &steps =
+        direction == Direction::Encrypt ? encryptSteps : decryptSteps;
+    if (steps.empty()) {
+      std::memmove(output.data(), input.data(), input.size());
+      return input.size();
+    }
+    for (size_t pos = 0; pos < input.size(); pos += pipelineTileSize) {
+      size_t len = std::min(pipelineTileSize, input.size() - pos);
+      std::span<const char> source = input.subspan(pos, len);
+      std::span<char> tile = output.subspan(pos, len);
+      for (const Step &step : steps) {
+        apply(step, source, tile, offset + pos);
+        source = tile;
+      }
+    }
+    return input.size();
+  }
+
+public:
+  static constexpr bool preservesLength = true; ///< Длина текста не меняется
+
+  /**
+   * @brief Добавление ступени в конец цепочки
+   * @tparam Impl Шифр с CipherBase, сохраняющий длину
+   * @param cipher Подготовленный шифр (разделяется с цепочкой)
+   * @param direction Направление ступени при шифровании цепочкой
+   * @return Цепочка (для последовательных вызовов)
+   * @details Побайтовая замена сливается с соседней таблицей: из двух таблиц
+   *          получается одна, и ступень не стоит ничего при обработке
+   */
+  template <class Impl>
+  CipherPipeline &add(std::shared_ptr<const Impl> cipher,
+                      Direction direction = Direction::Encrypt) {
+    static_assert(Impl::preservesLength,
+                  "Ступень цепочки должна сохранять длину текста");
+    if constexpr (isByteMapCipher<Impl>) {
+      std::array<char, 256> forward = byteTable(*cipher, direction);
+      std::array<char, 256> backward =
+          byteTable(*cipher, opposite(direction));
+      if (!encryptSteps.empty() && !encryptSteps.back().cipher) {
+        for (char &c : encryptSteps.back().table) {
+          c = forward[static_cast<unsigned char>(c)];
+        }
+      } else {
+        encryptSteps.push_back({forward, nullptr, direction});
+      }
+      if (!decryptSteps.empty() && !decryptSteps.front().cipher) {
+        std::array<char, 256> &table = decryptSteps.front().table;
+        for (char &c : backward) {
+          c = table[static_cast<unsigned char>(c)];
+        }
+        table = backward;
+      } else {
+        decryptSteps.insert(decryptSteps.begin(),
+                            {backward, nullptr, opposite(direction)});
+      }
+    } else {
+      auto stage = std::make_shared<const CipherAdapter<Impl>>(cipher);
+      encryptSteps.push_back({{}, stage, direction});
+      decryptSteps.insert(decryptSteps.begin(),
+                          {{}, stage, opposite(direction)});
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Число шагов выполнения после слияния таблиц
+   * @return Число проходов по каждому тайлу при шифровании
+   */
+  size_t stepCount() const { return encryptSteps.size(); }
+};
+
+#endif // PIPELINE_H
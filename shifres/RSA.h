@@ -9,11 +9,18 @@
 #ifndef RSA_H
 #define RSA_H
 
-#include <cctype>  // Для tolower()
-#include <conio.h> // Для kbhit() и getch()
+#include "Cipher.h"
+#include "Console.h"
+#include "ContextCache.h"
+#include <cctype> // Для tolower()
+#include <charconv>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 using namespace std;
 
@@ -59,6 +66,151 @@ long long stepen(long long base, long long exp, long long mod) {
   return result;
 }
 
+/**
+ * @brief Проверка простоты числа пробным делением
+ * @param value Число
+ * @return true, если число простое
+ * @details Модуль RSA здесь меньше 3,04e9, поэтому делителей до корня из
+ *          множителя не больше нескольких десятков тысяч
+ */
+inline bool isPrime(long long value) {
+  if (value < 2) {
+    return false;
+  }
+  for (long long divisor = 2; divisor <= value / divisor; ++divisor) {
+    if (value % divisor == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @struct RsaKey
+ * @brief Открытый и секретный ключи RSA, вычисленные один раз
+ *
+ * Секретная экспонента находится расширенным алгоритмом Евклида, а не
+ * перебором, поэтому ключ строится за O(log n) для любых допустимых p и q.
+ * Через общий интерфейс шифров (transform) обрабатывается текст из
+ * десятичных чисел, разделённых пробельными символами; результаты
+ * записываются по одному в строке.
+ */
+struct RsaKey : public CipherBase<RsaKey> {
+  long long n; ///< Модуль p * q
+  long long e; ///< Открытая экспонента
+  long long d; ///< Секретная экспонента
+
+  static constexpr bool preservesLength = false; ///< Текст из чисел
+
+  /**
+   * @brief Вычисление ключей по двум простым числам и открытой экспоненте
+   * @param p Первое простое число
+   * @param q Второе простое число
+   * @param exponent Открытая экспонента
+   * @throw std::invalid_argument Если p или q меньше 2, не простые или
+   * совпадают, n слишком велико для умножения в long long или экспонента не
+   * взаимно проста с функцией Эйлера
+   */
+  RsaKey(long long p, long long q, long long exponent) : e(exponent) {
+    if (p < 2 || q < 2) {
+      throw invalid_argument("Числа ключа должны быть больше 1");
+    }
+    if (p > 3037000499LL / q) {
+      throw invalid_argument("Произведение чисел ключа слишком велико");
+    }
+    if (!isPrime(p) || !isPrime(q)) {
+      throw invalid_argument("Числа ключа должны быть простыми");
+    }
+    if (p == q) {
+      throw invalid_argument("Числа ключа должны быть различными");
+    }
+    n = p * q;
+    long long phi = (p - 1) * (q - 1);
+    long long r0 = phi, r1 = e % phi, t0 = 0, t1 = 1;
+    while (r1 > 0) {
+      long long quotient = r0 / r1;
+      std::swap(r0, r1);
+      r1 -= quotient * r0;
+      std::swap(t0, t1);
+      t1 -= quotient * t0;
+    }
+    if (e < 1 || r0 != 1) {
+      throw invalid_argument(
+          "Открытая экспонента должна быть взаимно простой с функцией Эйлера");
+    }
+    d = (t0 % phi + phi) % phi;
+  }
+
+  /**
+   * @brief Шифрование числа
+   * @param message Число от 0 до n - 1
+   * @return message^e mod n
+   */
+  long long encrypt(long long message) const { return stepen(message, e, n); }
+
+  /**
+   * @brief Расшифрование числа
+   * @param cipher Число от 0 до n - 1
+   * @return cipher^d mod n
+   */
+  long long decrypt(long long cipher) const { return stepen(cipher, d, n); }
+
+  /**
+   * @brief Наибольшая длина результата (см. CipherBase)
+   * @param inputSize Длина входа
+   * @return Число чисел во входе не больше (inputSize + 1) / 2, каждое
+   * результирующее число занимает не больше разрядов n и перевод строки
+   */
+  size_t maxOutputImpl(size_t inputSize, Direction) const {
+    return (inputSize + 1) / 2 * (std::to_string(n - 1).size() + 1);
+  }
+
+  /**
+   * @brief Ядро шифра (см. CipherBase)
+   * @param input Десятичные числа через пробельные символы
+   * @param output Буфер не короче maxOutputImpl (не пересекается с input)
+   * @param direction Направление
+   * @return Длина результата
+   * @throw std::invalid_argument Если во входе есть символ, отличный от цифр и
+   * пробельных, или число не меньше n
+   */
+  size_t transformImpl(std::span<const char> input, std::span<char> output,
+                       Direction direction, size_t) const {
+    char *out = output.data();
+    size_t pos = 0;
+    while (pos < input.size()) {
+      unsigned char c = input[pos];
+      if (isspace(c)) {
+        ++pos;
+        continue;
+      }
+      if (!isdigit(c)) {
+        throw invalid_argument(std::string("Недопустимый символ '") +
+                               input[pos] + "' во входных числах");
+      }
+      size_t begin = pos;
+      long long value = 0;
+      for (; pos < input.size() && isdigit(static_cast<unsigned char>(
+                                       input[pos]));
+           ++pos) {
+        if (value < n) {
+          value = value * 10 + (input[pos] - '0');
+        }
+      }
+      if (value >= n) {
+        throw invalid_argument("Число " +
+                               std::string(input.data() + begin, pos - begin) +
+                               " не меньше модуля n");
+      }
+      long long result =
+          direction == Direction::Encrypt ? encrypt(value) : decrypt(value);
+      out = std::to_chars(out, output.data() + output.size(), result).ptr;
+      *out++ = '\n';
+    }
+    return out - output.data();
+  }
+};
+
 /**
  * @brief Основная функция RSA шифрования и расшифрования
  * @param key Строка с двумя простыми числами через пробел (например "17 19")
@@ -105,8 +257,6 @@ int main_RSA(string key_vvod, int e_vvod, int text_vvod, int mod) {
     /** @brief Второе простое число */
     int q = stoi(key.substr(pos + 1));
 
-    /** @brief Модуль RSA - произведение двух простых чисел */
-    int n = p * q;
     /** @brief Функция Эйлера - количество чисел, взаимно простых с n */
     int f_n = (p - 1) * (q - 1); // Функция Эйлера
     cout << "\nВведите открытую экспоненту - число от 1 до " +
@@ -120,59 +270,59 @@ int main_RSA(string key_vvod, int e_vvod, int text_vvod, int mod) {
     } else {
       e = e_vvod;
     }
-    /** @brief Секретная экспонента - обратная к e по модулю f_n */
-    int d;
-    d = mod_inverse(e, f_n);
+    /** @brief Ключи RSA: секретная экспонента d, обратная к e по модулю f_n,
+     * вычисляется один раз для каждой тройки (p, q, e) */
+    std::shared_ptr<const RsaKey> rsa = cachedContext<RsaKey>(
+        {"rsa", std::to_string(p), std::to_string(q), std::to_string(e)}, p,
+        q, e);
 
     cout << "\nДля зашифрования нажмите -->" << endl;
     cout << "Для расшифрования нажмите <--" << endl;
 
     while (true) {
-      if (_kbhit() || mod != 0) {
-        /** @brief Код нажатой стрелки для выбора операции */
-        int arrow;
-        if (mod == 0) {
-          arrow = _getch();
+      /** @brief Код нажатой стрелки для выбора операции */
+      int arrow = mod == 0 ? readKey() : 0;
+      if (arrow == KeyEnd) {
+        break;
+      }
+      if (arrow == KeyRight || mod == 1) {
+        cout << "\nВведите открытый текст:" << endl;
+        /** @brief Исходное число для шифрования */
+        int open_text;
+        if (text_vvod == -1) {
+          cin >> open_text;
+          cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        } else {
+          open_text = text_vvod;
         }
-        if (arrow == 77 || mod == 1) {
-          cout << "\nВведите открытый текст:" << endl;
-          /** @brief Исходное число для шифрования */
-          int open_text;
-          if (text_vvod == -1) {
-            cin >> open_text;
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-          } else {
-            open_text = text_vvod;
-          }
-
-          /** @brief Зашифрованное число */
-          int shifr;
-          shifr = stepen(open_text, e, n);
-
-          cout << "\nШифр-сообщение:" << endl;
-          cout << shifr << endl;
-          return shifr;
-          break;
-        } else if (arrow == 75 || mod == 2) {
-          cout << "\nВведите шифр-сообщение:" << endl;
-          /** @brief Зашифрованное число для расшифрования */
-          int shifr;
-          if (text_vvod == -1) {
-            cin >> shifr;
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-          } else {
-            shifr = text_vvod;
-          }
-
-          /** @brief Расшифрованное исходное число */
-          int open_text;
-          open_text = stepen(shifr, d, n);
-
-          cout << "\nИсходное сообщение:" << endl;
-          cout << open_text << endl;
-          return open_text;
-          break;
+
+        /** @brief Зашифрованное число */
+        int shifr;
+        shifr = rsa->encrypt(open_text);
+
+        cout << "\nШифр-сообщение:" << endl;
+        cout << shifr << endl;
+        return shifr;
+        break;
+      } else if (arrow == KeyLeft || mod == 2) {
+        cout << "\nВведите шифр-сообщение:" << endl;
+        /** @brief Зашифрованное число для расшифрования */
+        int shifr;
+        if (text_vvod == -1) {
+          cin >> shifr;
+          cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        } else {
+          shifr = text_vvod;
         }
+
+        /** @brief Расшифрованное исходное число */
+        int open_text;
+        open_text = rsa->decrypt(shifr);
+
+        cout << "\nИсходное сообщение:" << endl;
+        cout << open_text << endl;
+        return open_text;
+        break;
       }
     }
   } catch (exception &f) {
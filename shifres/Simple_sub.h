@@ -1,9 +1,11 @@
 #ifndef SIMPLE_SUBSTITUTION_H
 #define SIMPLE_SUBSTITUTION_H
 
+#include "Cipher.h"
+#include <array>
+#include <span>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
 
 /**
  * @class SimpleSubstitution
@@ -12,45 +14,84 @@
  * Класс предоставляет функциональность для шифрования и дешифрования текста
  * с использованием алфавитной подстановки.
  */
-class SimpleSubstitution {
-  std::unordered_map<char, char>
-      encryptMap; ///< Карта для шифрования (символ → замена)
-  std::unordered_map<char, char>
-      decryptMap; ///< Карта для дешифрования (замена → символ)
+class SimpleSubstitution : public CipherBase<SimpleSubstitution> {
+  friend class CipherBase<SimpleSubstitution>;
+
+  std::array<char, 256> encryptTable; ///< Байт открытого текста -> замена
+  std::array<char, 256> decryptTable; ///< Байт шифртекста -> исходный символ
+
+  /**
+   * @brief Ядро шифра (см. CipherBase): замена байтов по таблице
+   * @param input Вход
+   * @param output Выход (может совпадать с input)
+   * @param direction Направление
+   * @return Длина результата
+   */
+  size_t transformImpl(std::span<const char> input, std::span<char> output,
+                       Direction direction, size_t) const {
+    const std::array<char, 256> &table =
+        direction == Direction::Encrypt ? encryptTable : decryptTable;
+    for (size_t i = 0; i < input.size(); ++i) {
+      output[i] = table[static_cast<unsigned char>(input[i])];
+    }
+    return input.size();
+  }
 
 public:
+  static constexpr bool preservesLength = true; ///< Длина текста не меняется
+  static constexpr bool mapsBytes = true;       ///< Побайтовая замена
+
   /**
    * @brief Конструктор, инициализирующий подстановочные таблицы
    * @param key Строка из 26 уникальных символов - подстановочный алфавит
    * @throw std::invalid_argument Если ключ не соответствует требованиям
+   * @details Буквы обоих регистров заменяются по ключу (заглавные - как
+   *          строчные), остальные байты отображаются сами в себя. Буква,
+   *          отсутствующая в ключе, расшифровывается в нулевой символ
    */
   SimpleSubstitution(const std::string &key) {
     if (key.length() != 26) {
       throw std::invalid_argument("Ключ должен содержать ровно 26 символов");
     }
 
+    std::array<char, 256> inverse{};
+    for (char c = 'a'; c <= 'z'; ++c) {
+      inverse[static_cast<unsigned char>(key[c - 'a'])] = c;
+    }
+    for (int c = 0; c < 256; ++c) {
+      encryptTable[c] = decryptTable[c] = static_cast<char>(c);
+    }
     for (char c = 'a'; c <= 'z'; ++c) {
-      encryptMap[c] = key[c - 'a'];
-      decryptMap[key[c - 'a']] = c;
+      char upper = c - 'a' + 'A';
+      encryptTable[c] = encryptTable[upper] = key[c - 'a'];
+      decryptTable[c] = decryptTable[upper] = inverse[c];
     }
   }
 
+  /**
+   * @brief Шифрование на месте
+   * @param data Текст
+   */
+  void encryptInPlace(std::span<char> data) const {
+    transformInPlace(data, Direction::Encrypt);
+  }
+
+  /**
+   * @brief Расшифрование на месте
+   * @param data Шифртекст
+   */
+  void decryptInPlace(std::span<char> data) const {
+    transformInPlace(data, Direction::Decrypt);
+  }
+
   /**
    * @brief Шифрует текст методом простой подстановки
    * @param plaintext Исходный текст для шифрования
    * @return Зашифрованная строка (неалфавитные символы остаются без изменений)
    */
-  std::string encrypt(const std::string &plaintext) {
-    std::string ciphertext;
-    for (char c : plaintext) {
-      if (isalpha(c)) {
-        char lower = tolower(c);
-        ciphertext += encryptMap[lower];
-      } else {
-        ciphertext += c;
-      }
-    }
-    return ciphertext;
+  std::string encrypt(std::string plaintext) const {
+    encryptInPlace(plaintext);
+    return plaintext;
   }
 
   /**
@@ -58,18 +99,10 @@ public:
    * @param ciphertext Зашифрованный текст для дешифрования
    * @return Расшифрованная строка (неалфавитные символы остаются без изменений)
    */
-  std::string decrypt(const std::string &ciphertext) {
-    std::string plaintext;
-    for (char c : ciphertext) {
-      if (isalpha(c)) {
-        char lower = tolower(c);
-        plaintext += decryptMap[lower];
-      } else {
-        plaintext += c;
-      }
-    }
-    return plaintext;
+  std::string decrypt(std::string ciphertext) const {
+    decryptInPlace(ciphertext);
+    return ciphertext;
   }
 };
 
-#endif // SIMPLE_SUBSTITUTION_H
\ No newline at end of file
+#endif // SIMPLE_SUBSTITUTION_H
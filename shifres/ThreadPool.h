@@ -0,0 +1,171 @@
+/**
+ * @file threadpool.h
+ * @brief Пул потоков для параллельной обработки больших буферов
+ * @details Потоки создаются один раз и ждут заданий, поэтому параллельная
+ *          обработка не тратит время на создание потоков при каждом вызове.
+ *          Работа делится статически: каждый поток получает один непрерывный
+ *          участок буфера
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Фиксированный набор потоков, выполняющих одно задание на всех
+ *
+ * Задание - функция от номера части (от 0 до size() - 1); вызывающий поток
+ * сам выполняет часть 0. Задания из разных потоков выполняются по очереди.
+ * Задание не должно запускать новое задание в том же пуле.
+ */
+class ThreadPool {
+  std::vector<std::thread> workers;   ///< Рабочие потоки
+  std::mutex runMutex;                ///< Очередь заданий
+  std::mutex mutex;                   ///< Защита полей ниже
+  std::condition_variable wake;       ///< Появилось задание
+  std::condition_variable done;       ///< Все части выполнены
+  std::function<void(unsigned)> task; ///< Текущее задание
+  unsigned long long generation = 0;  ///< Номер текущего задания
+  unsigned pending = 0;               ///< Невыполненные части
+  std::exception_ptr error;           ///< Первое исключение задания
+  bool stopping = false;              ///< Пул уничтожается
+
+  /**
+   * @brief Цикл рабочего потока
+   * @param part Номер части, которую выполняет поток
+   */
+  void workerLoop(unsigned part) {
+    unsigned long long seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      wake.wait(lock, [&] { return stopping || generation != seen; });
+      if (stopping) {
+        return;
+      }
+      seen = generation;
+      lock.unlock();
+      std::exception_ptr failure;
+      try {
+        task(part);
+      } catch (...) {
+        failure = std::current_exception();
+      }
+      lock.lock();
+      if (failure && !error) {
+        error = failure;
+      }
+      if (--pending == 0) {
+        done.notify_one();
+      }
+    }
+  }
+
+public:
+  /**
+   * @brief Создание пула
+   * @param threads Общее число потоков вместе с вызывающим (0 - по числу
+   * ядер)
+   */
+  explicit ThreadPool(unsigned threads = 0) {
+    if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned part = 1; part < threads; ++part) {
+      workers.emplace_back(&ThreadPool::workerLoop, this, part);
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @brief Число частей, на которые делится задание
+   * @return Число рабочих потоков плюс вызывающий
+   */
+  unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+  /**
+   * @brief Выполнение задания на всех потоках с ожиданием завершения
+   * @param work Функция от номера части
+   * @throw Первое исключение, выброшенное какой-либо частью
+   */
+  void run(const std::function<void(unsigned)> &work) {
+    std::lock_guard<std::mutex> order(runMutex);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      task = work;
+      pending = size() - 1;
+      error = nullptr;
+      ++generation;
+    }
+    wake.notify_all();
+    std::exception_ptr failure;
+    try {
+      work(0);
+    } catch (...) {
+      failure = std::current_exception();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return pending == 0; });
+    task = nullptr;
+    if (!failure) {
+      failure = error;
+    }
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+  }
+
+  /**
+   * @brief Статическое разбиение диапазона на непрерывные участки
+   * @param length Длина диапазона
+   * @param grain Кратность границ участков (например, размер страницы)
+   * @param work Функция от начала и конца участка
+   * @details Каждый поток получает не больше одного участка; пустые участки
+   *          не передаются в work
+   */
+  void parallelFor(size_t length, size_t grain,
+                   const std::function<void(size_t, size_t)> &work) {
+    size_t parts = size();
+    size_t chunk = (length + parts - 1) / parts;
+    chunk = (chunk + grain - 1) / grain * grain;
+    run([&](unsigned part) {
+      size_t begin = std::min(length, part * chunk);
+      size_t end = std::min(length, begin + chunk);
+      if (begin < end) {
+        work(begin, end);
+      }
+    });
+  }
+
+  /**
+   * @brief Общий пул процесса
+   * @return Пул с числом потоков по числу ядер (создаётся при первом вызове)
+   */
+  static ThreadPool &shared() {
+    static ThreadPool pool;
+    return pool;
+  }
+};
+
+#endif // THREAD_POOL_H
@@ -1,9 +1,118 @@
 #ifndef VERNAM_CIPHER_H
 #define VERNAM_CIPHER_H
 
+#include "ChaCha20.h"
+#include "Cipher.h"
+#include "ThreadPool.h"
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define VERNAM_SIMD_KERNEL 1
+#endif
+
+/**
+ * @brief Тип функции, выполняющей out[i] = in[i] ^ key[i]
+ */
+using XorKernel = void (*)(const char *in, const char *key, char *out,
+                           size_t size);
+
+/**
+ * @brief XOR словами по 64 бита (переносимый вариант)
+ * @param in Входные данные
+ * @param key Ключевые байты той же длины
+ * @param out Результат (может совпадать с in)
+ * @param size Число байт
+ */
+inline void xorWords(const char *in, const char *key, char *out, size_t size) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t a, b;
+    std::memcpy(&a, in + i, 8);
+    std::memcpy(&b, key + i, 8);
+    a ^= b;
+    std::memcpy(out + i, &a, 8);
+  }
+  for (; i < size; ++i) {
+    out[i] = in[i] ^ key[i];
+  }
+}
+
+#ifdef VERNAM_SIMD_KERNEL
+/**
+ * @brief XOR векторами AVX2 по 32 байта
+ * @param in Входные данные
+ * @param key Ключевые байты той же длины
+ * @param out Результат (может совпадать с in)
+ * @param size Число байт
+ */
+__attribute__((target("avx2"))) inline void
+xorAvx2(const char *in, const char *key, char *out, size_t size) {
+  size_t i = 0;
+  for (; i + 64 <= size; i += 64) {
+    __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    __m256i a1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 32));
+    __m256i k0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key + i));
+    __m256i k1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key + i + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_xor_si256(a0, k0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 32),
+                        _mm256_xor_si256(a1, k1));
+  }
+  xorWords(in + i, key + i, out + i, size - i);
+}
+
+/**
+ * @brief XOR векторами AVX-512 по 64 байта
+ * @param in Входные данные
+ * @param key Ключевые байты той же длины
+ * @param out Результат (может совпадать с in)
+ * @param size Число байт
+ */
+__attribute__((target("avx512f"))) inline void
+xorAvx512(const char *in, const char *key, char *out, size_t size) {
+  size_t i = 0;
+  for (; i + 64 <= size; i += 64) {
+    __m512i a = _mm512_loadu_si512(in + i);
+    __m512i k = _mm512_loadu_si512(key + i);
+    _mm512_storeu_si512(out + i, _mm512_xor_si512(a, k));
+  }
+  xorWords(in + i, key + i, out + i, size - i);
+}
+#endif
+
+/**
+ * @brief Выбор самого быстрого XOR-ядра для текущего процессора
+ * @return Указатель на ядро; выбор делается один раз за запуск
+ */
+inline XorKernel selectXorKernel() {
+  static const XorKernel kernel = [] {
+#ifdef VERNAM_SIMD_KERNEL
+    if (__builtin_cpu_supports("avx512f")) {
+      return &xorAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return &xorAvx2;
+    }
+#endif
+    return &xorWords;
+  }();
+  return kernel;
+}
+
+/// Граница участков параллельной обработки (страница памяти)
+constexpr size_t parallelXorGrain = cipherParallelGrain;
+
+/// Буферы короче этого размера обрабатываются в вызывающем потоке
+constexpr size_t parallelXorMinSize = cipherParallelMinSize;
 
 /**
  * @class VernamCipher
@@ -14,19 +123,55 @@
  * Примечание: Для реальной криптографической стойкости ключ должен быть
  * истинно случайным и равным по длине сообщению (одноразовый блокнот).
  */
-class VernamCipher {
-  std::string key; ///< Ключ для шифрования/дешифрования
+class VernamCipher : public CipherBase<VernamCipher> {
+  friend class CipherBase<VernamCipher>;
+
+  std::string key;               ///< Ключ для шифрования/дешифрования
+  std::vector<char> expandedKey; ///< Ключ, развёрнутый на period + |key| байт
+  size_t period;                 ///< Длина участка, кратная длине ключа
+
+  static constexpr size_t minPeriod = 4096; ///< Нижняя граница period
+
+  /**
+   * @brief Ядро шифра (см. CipherBase); направление не важно
+   * @param input Входные данные
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param offset Позиция input[0] в потоке (определяет фазу ключа)
+   * @return Длина результата
+   */
+  size_t transformImpl(std::span<const char> input, std::span<char> output,
+                       Direction, size_t offset) const {
+    XorKernel kernel = selectXorKernel();
+    const char *phase = expandedKey.data() + offset % key.size();
+    for (size_t pos = 0; pos < input.size(); pos += period) {
+      size_t len = std::min(period, input.size() - pos);
+      kernel(input.data() + pos, phase, output.data() + pos, len);
+    }
+    return input.size();
+  }
 
 public:
+  static constexpr bool preservesLength = true; ///< Длина текста не меняется
+
   /**
    * @brief Конструктор, инициализирующий ключ шифрования
    * @param k Ключевая строка
    * @throw std::invalid_argument Если ключ пустой
+   * @details Ключ один раз разворачивается в буфер длины period + |k|, где
+   *          period кратен |k|. Тогда участок из period байт, начинающийся с
+   *          фазы ключа p, XOR-ится с expandedKey[p..p+period) без взятия
+   *          остатка на каждом байте, а фаза после участка не меняется
    */
   VernamCipher(const std::string &k) : key(k) {
     if (key.empty()) {
       throw std::invalid_argument("Ключ не может быть пустым");
     }
+    period = (minPeriod + key.size() - 1) / key.size() * key.size();
+    expandedKey.resize(period + key.size());
+    for (size_t i = 0; i < expandedKey.size(); i += key.size()) {
+      std::copy_n(key.begin(), std::min(key.size(), expandedKey.size() - i),
+                  expandedKey.begin() + i);
+    }
   }
 
   /**
@@ -49,6 +194,44 @@ public:
     return process(ciphertext);
   }
 
+  /**
+   * @brief XOR с ключом из входного буфера в выходной
+   * @param input Входные данные
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param offset Позиция input[0] в потоке (определяет фазу ключа)
+   * @throw std::invalid_argument Если выходной буфер короче входного
+   */
+  void process(std::span<const char> input, std::span<char> output,
+               size_t offset = 0) const {
+    transform(input, output, Direction::Encrypt, offset);
+  }
+
+  /**
+   * @brief XOR с ключом на месте
+   * @param data Данные
+   * @param offset Позиция data[0] в потоке (определяет фазу ключа)
+   */
+  void processInPlace(std::span<char> data, size_t offset = 0) const {
+    process(data, data, offset);
+  }
+
+  /**
+   * @brief Параллельный XOR с ключом из входного буфера в выходной
+   * @param input Входные данные
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param offset Позиция input[0] в потоке
+   * @param pool Пул потоков
+   * @throw std::invalid_argument Если выходной буфер короче входного
+   * @details Участок, начинающийся с позиции b, обрабатывается с фазой
+   *          ключа (offset + b) mod |key| (см. CipherBase::transformParallel).
+   *          Результат совпадает с process
+   */
+  void processParallel(std::span<const char> input, std::span<char> output,
+                       size_t offset = 0,
+                       ThreadPool &pool = ThreadPool::shared()) const {
+    transformParallel(input, output, Direction::Encrypt, offset, pool);
+  }
+
 private:
   /**
    * @brief Основная обработка данных (XOR с ключом)
@@ -56,14 +239,145 @@ private:
    * @return Результат XOR-операции с ключом
    */
   std::string process(const std::string &input) {
-    std::string output;
-    for (size_t i = 0; i < input.size(); ++i) {
-      char inputChar = input[i];
-      char keyChar = key[i % key.size()];
-      output += inputChar ^ keyChar;
+    std::string output(input.size(), '\0');
+    process(input, output);
+    return output;
+  }
+};
+
+/**
+ * @class VernamKeystream
+ * @brief Шифр Вернама с гаммой, вырабатываемой из короткого ключа
+ *
+ * Вместо повторения ключа (что делает VernamCipher и что легко вскрывается)
+ * гамма вычисляется генератором ChaCha20 из ключа до 32 байт и 12-байтного
+ * nonce. Гамма для любого смещения вычисляется независимо, поэтому поток
+ * можно обрабатывать с любого места и по частям, не храня файлов блокнота.
+ * Стойкость ограничена энтропией ключа; одна пара (ключ, nonce) не должна
+ * использоваться для разных сообщений.
+ */
+class VernamKeystream {
+  ChaCha20 generator; ///< Генератор гаммы
+
+  static constexpr size_t chunkSize = 4096; ///< Размер участка гаммы
+
+  /**
+   * @brief Дополнение строки нулями до нужной длины
+   * @param text Исходная строка
+   * @param size Требуемая длина
+   * @param what Название параметра для сообщения об ошибке
+   * @return Байты строки, дополненные нулями
+   * @throw std::invalid_argument Если строка пуста (для ключа) или длиннее
+   * size
+   */
+  static std::string padded(const std::string &text, size_t size,
+                            const std::string &what) {
+    if (text.size() > size) {
+      throw std::invalid_argument(what + " длиннее " + std::to_string(size) +
+                                  " байт");
     }
+    std::string result = text;
+    result.resize(size, '\0');
+    return result;
+  }
+
+public:
+  /**
+   * @brief Конструктор, инициализирующий генератор гаммы
+   * @param seed Ключ от 1 до 32 байт (дополняется нулями)
+   * @param nonce Nonce до 12 байт (дополняется нулями)
+   * @throw std::invalid_argument Если ключ пустой или параметры слишком
+   * длинные
+   */
+  VernamKeystream(const std::string &seed, const std::string &nonce = "")
+      : generator(reinterpret_cast<const unsigned char *>(
+                      padded(seed, 32, "Ключ").data()),
+                  reinterpret_cast<const unsigned char *>(
+                      padded(nonce, 12, "Nonce").data())) {
+    if (seed.empty()) {
+      throw std::invalid_argument("Ключ не может быть пустым");
+    }
+  }
+
+  /**
+   * @brief Шифрует текст
+   * @param plaintext Текст для шифрования
+   * @return Зашифрованная строка (бинарные данные)
+   */
+  std::string encrypt(const std::string &plaintext) const {
+    std::string output(plaintext.size(), '\0');
+    process(plaintext, output);
     return output;
   }
+
+  /**
+   * @brief Дешифрует текст
+   * @param ciphertext Текст для дешифрования
+   * @return Расшифрованная строка
+   */
+  std::string decrypt(const std::string &ciphertext) const {
+    return encrypt(ciphertext);
+  }
+
+  /**
+   * @brief XOR с гаммой из входного буфера в выходной
+   * @param input Входные данные
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param offset Позиция input[0] в потоке
+   * @throw std::invalid_argument Если выходной буфер короче входного
+   * @throw std::out_of_range Если поток длиннее 256 ГБ
+   */
+  void process(std::span<const char> input, std::span<char> output,
+               uint64_t offset = 0) const {
+    if (output.size() < input.size()) {
+      throw std::invalid_argument("Выходной буфер слишком мал");
+    }
+    XorKernel kernel = selectXorKernel();
+    alignas(64) unsigned char gamma[chunkSize];
+    for (size_t pos = 0; pos < input.size(); pos += chunkSize) {
+      size_t len = std::min(chunkSize, input.size() - pos);
+      generator.keystream(offset + pos, gamma, len);
+      kernel(input.data() + pos, reinterpret_cast<const char *>(gamma),
+             output.data() + pos, len);
+    }
+  }
+
+  /**
+   * @brief XOR с гаммой на месте
+   * @param data Данные
+   * @param offset Позиция data[0] в потоке
+   */
+  void processInPlace(std::span<char> data, uint64_t offset = 0) const {
+    process(data, data, offset);
+  }
+
+  /**
+   * @brief Параллельный XOR с гаммой из входного буфера в выходной
+   * @param input Входные данные
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param offset Позиция input[0] в потоке
+   * @param pool Пул потоков
+   * @throw std::invalid_argument Если выходной буфер короче входного
+   * @throw std::out_of_range Если поток длиннее 256 ГБ
+   * @details Гамма для каждого участка вычисляется с его собственного
+   *          смещения, так что результат совпадает с process
+   */
+  void processParallel(std::span<const char> input, std::span<char> output,
+                       uint64_t offset = 0,
+                       ThreadPool &pool = ThreadPool::shared()) const {
+    if (output.size() < input.size()) {
+      throw std::invalid_argument("Выходной буфер слишком мал");
+    }
+    if (input.size() < parallelXorMinSize || pool.size() == 1) {
+      process(input, output, offset);
+      return;
+    }
+    pool.parallelFor(input.size(), parallelXorGrain,
+                     [&](size_t begin, size_t end) {
+                       process(input.subspan(begin, end - begin),
+                               output.subspan(begin), offset + begin);
+                     });
+  }
 };
 
-#endif // VERNAM_CIPHER_H
\ No newline at end of file
+#endif // VERNAM_CIPHER_H
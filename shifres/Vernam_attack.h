@@ -0,0 +1,304 @@
+/**
+ * @file vernam_attack.h
+ * @brief Вскрытие шифра Вернама с повторяющимся ключом
+ * @details VernamCipher повторяет короткий ключ, поэтому шифртекст, сдвинутый
+ *          на длину ключа, XOR-ится с собой в XOR двух открытых текстов.
+ *          Длина ключа находится по нормированному расстоянию Хэмминга
+ *          между шифртекстом и его сдвигом, после чего каждый байт ключа
+ *          подбирается отдельно по частотам байт открытого текста
+ */
+
+#ifndef VERNAM_ATTACK_H
+#define VERNAM_ATTACK_H
+
+#include "English.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XOR_ATTACK_SIMD_KERNEL 1
+#endif
+
+/**
+ * @brief Число различающихся бит между data[i] и data[i + shift]
+ * @param data Данные
+ * @param shift Сдвиг
+ * @param size Число сравниваемых пар (size + shift <= длины данных)
+ * @return Расстояние Хэмминга
+ */
+inline uint64_t shiftedHammingWords(const char *data, size_t shift,
+                                    size_t size) {
+  uint64_t bits = 0;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t a, b;
+    std::memcpy(&a, data + i, 8);
+    std::memcpy(&b, data + i + shift, 8);
+    bits += __builtin_popcountll(a ^ b);
+  }
+  for (; i < size; ++i) {
+    bits += __builtin_popcount(static_cast<unsigned char>(data[i] ^
+                                                          data[i + shift]));
+  }
+  return bits;
+}
+
+#ifdef XOR_ATTACK_SIMD_KERNEL
+/**
+ * @brief Расстояние Хэмминга со сдвигом на POPCNT
+ * @param data Данные
+ * @param shift Сдвиг
+ * @param size Число сравниваемых пар
+ * @return Расстояние Хэмминга
+ */
+__attribute__((target("popcnt"))) inline uint64_t
+shiftedHammingPopcnt(const char *data, size_t shift, size_t size) {
+  return shiftedHammingWords(data, shift, size);
+}
+
+/**
+ * @brief Расстояние Хэмминга со сдвигом в AVX2
+ * @param data Данные
+ * @param shift Сдвиг
+ * @param size Число сравниваемых пар
+ * @return Расстояние Хэмминга
+ * @details Биты в байтах считаются выборкой по полубайтам (vpshufb),
+ *          суммы байт накапливаются через vpsadbw
+ */
+__attribute__((target("avx2"))) inline uint64_t
+shiftedHammingAvx2(const char *data, size_t shift, size_t size) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                       2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0F);
+  __m256i total = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i x = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)),
+        _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(data + i + shift)));
+    __m256i counts = _mm256_add_epi8(
+        _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, low)),
+        _mm256_shuffle_epi8(lookup,
+                            _mm256_and_si256(_mm256_srli_epi16(x, 4), low)));
+    total = _mm256_add_epi64(total,
+                             _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+  }
+  alignas(32) uint64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+         shiftedHammingWords(data + i, shift, size - i);
+}
+#endif
+
+/**
+ * @brief Расстояние Хэмминга между данными и их сдвигом (выбор ядра)
+ * @param data Данные
+ * @param shift Сдвиг
+ * @param size Число сравниваемых пар
+ * @return Расстояние Хэмминга
+ */
+inline uint64_t shiftedHamming(const char *data, size_t shift, size_t size) {
+#ifdef XOR_ATTACK_SIMD_KERNEL
+  static const int level = __builtin_cpu_supports("avx2")     ? 2
+                           : __builtin_cpu_supports("popcnt") ? 1
+                                                              : 0;
+  if (level == 2) {
+    return shiftedHammingAvx2(data, shift, size);
+  }
+  if (level == 1) {
+    return shiftedHammingPopcnt(data, shift, size);
+  }
+#endif
+  return shiftedHammingWords(data, shift, size);
+}
+
+/**
+ * @brief Запуск функции в нескольких потоках
+ * @param threads Число потоков (0 - по числу ядер)
+ * @param work Функция от номера потока и числа потоков
+ */
+template <class Work> void runXorWorkers(unsigned threads, Work &&work) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t) {
+    pool.emplace_back(work, t, threads);
+  }
+  work(0u, threads);
+  for (auto &th : pool) {
+    th.join();
+  }
+}
+
+/**
+ * @brief Модель частот байт английского текста
+ * @return Логарифмы вероятностей всех 256 значений байта
+ * @details Пробел, строчные и заглавные буквы, цифры и знаки препинания
+ *          получают вероятности по типичным частотам, остальные байты -
+ *          малую вероятность
+ */
+inline std::array<double, 256> englishByteModel() {
+  std::array<double, 256> p;
+  p.fill(0.0005);
+  p[' '] = 18.0;
+  for (int i = 0; i < 26; ++i) {
+    p['a' + i] = englishLetterPercents[i] * 0.8;
+    p['A' + i] = englishLetterPercents[i] * 0.04;
+  }
+  for (char c : std::string(".,'\"-;:!?()\n")) {
+    p[static_cast<unsigned char>(c)] = 0.3;
+  }
+  for (char c = '0'; c <= '9'; ++c) {
+    p[static_cast<unsigned char>(c)] = 0.1;
+  }
+  double sum = 0;
+  for (double v : p) {
+    sum += v;
+  }
+  for (double &v : p) {
+    v = std::log(v / sum);
+  }
+  return p;
+}
+
+/**
+ * @brief Оценка длин ключа по нормированному расстоянию Хэмминга
+ * @param data Шифртекст
+ * @param maxKeySize Наибольшая проверяемая длина ключа
+ * @param threads Число потоков (0 - по числу ядер)
+ * @param sampleSize Сколько первых байт использовать
+ * @return Пары (длина ключа, доля различающихся бит), по возрастанию доли
+ * @details Для сдвига, кратного длине ключа, ключ сокращается, и доля
+ *          различающихся бит равна доле для двух открытых текстов - заметно
+ *          меньше, чем для остальных сдвигов. Длины ключа распределяются
+ *          между потоками
+ */
+inline std::vector<std::pair<size_t, double>>
+rankXorKeySizes(std::span<const char> data, size_t maxKeySize = 40,
+                unsigned threads = 0, size_t sampleSize = 64 << 20) {
+  size_t n = std::min(data.size(), sampleSize);
+  maxKeySize = std::min(maxKeySize, n / 2);
+  std::vector<std::pair<size_t, double>> result(maxKeySize);
+  runXorWorkers(threads, [&](unsigned t, unsigned count) {
+    for (size_t k = 1 + t; k <= maxKeySize; k += count) {
+      size_t pairs = n - k;
+      result[k - 1] = {k, static_cast<double>(shiftedHamming(data.data(), k,
+                                                             pairs)) /
+                              (8.0 * pairs)};
+    }
+  });
+  std::sort(result.begin(), result.end(),
+            [](const auto &a, const auto &b) { return a.second < b.second; });
+  return result;
+}
+
+/**
+ * @brief Подбор ключа известной длины по столбцам
+ * @param data Шифртекст
+ * @param keySize Длина ключа
+ * @param model Логарифмы вероятностей байт открытого текста
+ * @param threads Число потоков (0 - по числу ядер)
+ * @return Ключ
+ * @details Шифртекст делится между потоками на участки, каждый поток
+ *          считает гистограммы байт по столбцам (позиция mod keySize) с
+ *          учётом фазы своего участка. Затем для каждого столбца выбирается
+ *          байт ключа b с наибольшим правдоподобием sum count[c] *
+ *          model[c ^ b] - это требует 256 * 256 операций на столбец
+ *          независимо от длины шифртекста
+ */
+inline std::string solveXorKey(std::span<const char> data, size_t keySize,
+                               const std::array<double, 256> &model,
+                               unsigned threads = 0) {
+  if (keySize == 0) {
+    throw std::invalid_argument("Длина ключа должна быть положительной");
+  }
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<std::vector<uint64_t>> partial(
+      threads, std::vector<uint64_t>(keySize * 256, 0));
+  runXorWorkers(threads, [&](unsigned t, unsigned count) {
+    size_t chunk = (data.size() + count - 1) / count;
+    size_t begin = std::min(data.size(), t * chunk);
+    size_t end = std::min(data.size(), begin + chunk);
+    std::vector<uint64_t> &counts = partial[t];
+    size_t column = begin % keySize;
+    for (size_t i = begin; i < end; ++i) {
+      ++counts[column * 256 + static_cast<unsigned char>(data[i])];
+      if (++column == keySize) {
+        column = 0;
+      }
+    }
+  });
+  for (unsigned t = 1; t < threads; ++t) {
+    for (size_t i = 0; i < partial[0].size(); ++i) {
+      partial[0][i] += partial[t][i];
+    }
+  }
+
+  std::string key(keySize, '\0');
+  runXorWorkers(threads, [&](unsigned t, unsigned count) {
+    for (size_t column = t; column < keySize; column += count) {
+      const uint64_t *counts = &partial[0][column * 256];
+      double bestScore = -INFINITY;
+      for (int b = 0; b < 256; ++b) {
+        double score = 0;
+        for (int c = 0; c < 256; ++c) {
+          score += counts[c] * model[c ^ b];
+        }
+        if (score > bestScore) {
+          bestScore = score;
+          key[column] = static_cast<char>(b);
+        }
+      }
+    }
+  });
+  return key;
+}
+
+/**
+ * @brief Вскрытие шифртекста VernamCipher с неизвестным ключом
+ * @param data Шифртекст
+ * @param maxKeySize Наибольшая проверяемая длина ключа
+ * @param threads Число потоков (0 - по числу ядер)
+ * @return Восстановленный ключ
+ * @throw std::invalid_argument Если шифртекст короче двух байт или нет ни
+ * одной длины ключа для проверки (maxKeySize == 0)
+ * @details Кратные длины ключа дают ту же долю различающихся бит, что и сама
+ *          длина, поэтому из длин с долей не более чем на 5% выше наилучшей
+ *          выбирается наименьшая
+ */
+inline std::string breakRepeatingXor(std::span<const char> data,
+                                     size_t maxKeySize = 40,
+                                     unsigned threads = 0) {
+  if (data.size() < 2) {
+    throw std::invalid_argument("Шифртекст слишком короткий");
+  }
+  auto ranked = rankXorKeySizes(data, maxKeySize, threads);
+  if (ranked.empty()) {
+    throw std::invalid_argument("Нет длин ключа для проверки");
+  }
+  double limit = ranked.front().second * 1.05;
+  size_t keySize = ranked.front().first;
+  for (const auto &[size, distance] : ranked) {
+    if (distance <= limit) {
+      keySize = std::min(keySize, size);
+    }
+  }
+  return solveXorKey(data, keySize, englishByteModel(), threads);
+}
+
+#endif // VERNAM_ATTACK_H
@@ -0,0 +1,182 @@
+/**
+ * @file vernam_pad.h
+ * @brief Шифр Вернама с настоящим одноразовым блокнотом в файле
+ * @details Открытый текст, блокнот и результат отображаются в память (mmap),
+ *          и XOR выполняется прямо между отображениями без копирования.
+ *          Смещение в блокноте сохраняется рядом с ним, поэтому однажды
+ *          использованная часть блокнота больше не используется
+ */
+
+#ifndef VERNAM_PAD_H
+#define VERNAM_PAD_H
+
+#include "Filter.h"
+#include "MappedFile.h"
+#include "Vernam.h"
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/file.h>
+#include <unistd.h>
+
+/**
+ * @class VernamPad
+ * @brief Одноразовый блокнот в файле для шифрования больших файлов
+ *
+ * Шифрованный файл начинается с 8-байтного смещения в блокноте (little
+ * endian), за которым идут данные. Следующее неиспользованное смещение
+ * хранится в файле <блокнот>.offset и записывается на диск до начала
+ * шифрования, так что сбой посередине не приводит к повторному
+ * использованию блокнота. На время жизни объекта файл смещения блокируется
+ * (flock), чтобы два процесса не взяли одну и ту же часть блокнота.
+ */
+class VernamPad {
+  MappedFile pad;            ///< Отображённый блокнот
+  std::string offsetPath;    ///< Путь к файлу смещения
+  FileDescriptor offsetFile; ///< Заблокированный файл смещения
+  uint64_t nextOffset;       ///< Первый неиспользованный байт блокнота
+  bool populate;             ///< Использовать MAP_POPULATE
+
+  /**
+   * @brief Сохранение смещения на диск (write + fsync)
+   * @param value Новое смещение
+   * @throw std::runtime_error При ошибке записи
+   */
+  void storeOffset(uint64_t value) {
+    std::string text = std::to_string(value) + "\n";
+    if (pwrite(offsetFile.get(), text.data(), text.size(), 0) !=
+            static_cast<ssize_t>(text.size()) ||
+        ftruncate(offsetFile.get(), text.size()) != 0 ||
+        fsync(offsetFile.get()) != 0) {
+      throw std::runtime_error("Не удалось сохранить смещение блокнота " +
+                               offsetPath);
+    }
+  }
+
+  /**
+   * @brief Проверка, что результат не затрёт вход или блокнот
+   * @param input Отображённый входной файл
+   * @param outPath Путь к выходному файлу
+   * @throw std::runtime_error Если выходной файл совпадает с входным или с
+   * блокнотом: открытие с O_TRUNC уничтожило бы их данные
+   */
+  void checkOutput(const MappedFile &input, const std::string &outPath) const {
+    if (input.sameFile(outPath) || pad.sameFile(outPath)) {
+      throw std::runtime_error("Выходной файл совпадает с входным: " +
+                               outPath);
+    }
+  }
+
+public:
+  /**
+   * @brief Открытие блокнота
+   * @param padPath Путь к файлу блокнота
+   * @param prefault Заранее подгружать страницы файлов (MAP_POPULATE)
+   * @throw std::runtime_error Если блокнот не открывается, уже используется
+   * другим процессом или файл смещения повреждён
+   */
+  VernamPad(const std::string &padPath, bool prefault = false)
+      : pad(padPath, prefault), offsetPath(padPath + ".offset"),
+        offsetFile(offsetPath, O_RDWR | O_CREAT, 0600), nextOffset(0),
+        populate(prefault) {
+    if (flock(offsetFile.get(), LOCK_EX | LOCK_NB) != 0) {
+      throw std::runtime_error("Блокнот уже используется: " + padPath);
+    }
+    char buffer[32];
+    ssize_t got = pread(offsetFile.get(), buffer, sizeof(buffer), 0);
+    if (got < 0) {
+      throw std::runtime_error("Не удалось прочитать файл смещения " +
+                               offsetPath);
+    }
+    const char *end = buffer + got;
+    while (end > buffer && isspace(static_cast<unsigned char>(end[-1]))) {
+      --end;
+    }
+    if (end > buffer) {
+      auto [last, error] = std::from_chars(buffer, end, nextOffset);
+      if (error != std::errc() || last != end) {
+        throw std::runtime_error("Повреждён файл смещения " + offsetPath);
+      }
+    }
+  }
+
+  VernamPad(const VernamPad &) = delete;
+  VernamPad &operator=(const VernamPad &) = delete;
+
+  /**
+   * @brief Число ещё не использованных байт блокнота
+   * @return Остаток блокнота
+   */
+  uint64_t remaining() const {
+    return nextOffset < pad.size() ? pad.size() - nextOffset : 0;
+  }
+
+  /**
+   * @brief Текущее смещение в блокноте
+   * @return Первый неиспользованный байт
+   */
+  uint64_t offset() const { return nextOffset; }
+
+  /**
+   * @brief Шифрование файла очередной частью блокнота
+   * @param inPath Файл открытого текста
+   * @param outPath Файл шифртекста (перезаписывается)
+   * @throw std::runtime_error Если остатка блокнота не хватает, выходной
+   * файл совпадает с входным или при ошибках ввода-вывода
+   */
+  void encryptFile(const std::string &inPath, const std::string &outPath) {
+    MappedFile input(inPath, populate);
+    checkOutput(input, outPath);
+    if (input.size() > remaining()) {
+      throw std::runtime_error("Остатка блокнота не хватает для файла " +
+                               inPath);
+    }
+    uint64_t start = nextOffset;
+    storeOffset(start + input.size());
+    nextOffset = start + input.size();
+
+    MappedFile output(outPath, input.size() + 8, populate);
+    for (int i = 0; i < 8; ++i) {
+      output.bytes()[i] = static_cast<unsigned char>(start >> (8 * i));
+    }
+    selectXorKernel()(reinterpret_cast<const char *>(input.bytes()),
+                      reinterpret_cast<const char *>(pad.bytes() + start),
+                      reinterpret_cast<char *>(output.bytes() + 8),
+                      input.size());
+  }
+
+  /**
+   * @brief Расшифрование файла, зашифрованного encryptFile
+   * @param inPath Файл шифртекста
+   * @param outPath Файл открытого текста (перезаписывается)
+   * @throw std::runtime_error Если файл повреждён, блокнот короче нужного,
+   * выходной файл совпадает с входным или при ошибках ввода-вывода
+   */
+  void decryptFile(const std::string &inPath, const std::string &outPath) {
+    MappedFile input(inPath, populate);
+    checkOutput(input, outPath);
+    if (input.size() < 8) {
+      throw std::runtime_error("Файл не является шифртекстом: " + inPath);
+    }
+    uint64_t start = 0;
+    for (int i = 0; i < 8; ++i) {
+      start |= static_cast<uint64_t>(input.bytes()[i]) << (8 * i);
+    }
+    size_t size = input.size() - 8;
+    if (start > pad.size() || size > pad.size() - start) {
+      throw std::runtime_error("Блокнот короче шифртекста " + inPath);
+    }
+
+    MappedFile output(outPath, size, populate);
+    if (size > 0) {
+      selectXorKernel()(reinterpret_cast<const char *>(input.bytes() + 8),
+                        reinterpret_cast<const char *>(pad.bytes() + start),
+                        reinterpret_cast<char *>(output.bytes()), size);
+    }
+  }
+};
+
+#endif // VERNAM_PAD_H
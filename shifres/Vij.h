@@ -9,14 +9,499 @@
 #ifndef VIJ_H
 #define VIJ_H
 
-#include <cctype>  // Для tolower()
-#include <conio.h> // For _kbhit() and _getch()
+#include "Cipher.h"
+#include "Console.h"
+#include "ContextCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cctype> // Для tolower()
 #include <iostream>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define VIGENERE_SIMD_KERNEL 1
+#endif
+
 using namespace std;
 
+/**
+ * @brief Тип функции сдвига для непрерывного алфавита
+ * @details Функция обрабатывает байты, пока не встретит блок с символом вне
+ *          алфавита, и возвращает число обработанных байт
+ */
+using VigenereKernel = size_t (*)(const char *in, const unsigned char *back,
+                                  char *out, size_t size, unsigned char base,
+                                  unsigned m);
+
+#ifdef VIGENERE_SIMD_KERNEL
+/**
+ * @brief Сдвиг по модулю m векторами AVX2 по 32 байта
+ * @param in Входной текст
+ * @param back Для каждой позиции (m - сдвиг) mod 256, 1 <= m - сдвиг <= m
+ * @param out Результат (может совпадать с in)
+ * @param size Число байт
+ * @param base Код первого символа алфавита
+ * @param m Размер алфавита (base + m <= 256)
+ * @return Число обработанных байт (кратно 32)
+ * @details Индекс x = in - base складывается со сдвигом как x - back с
+ *          прибавлением m, если x < back; так сумма не выходит за байт при
+ *          любом m
+ */
+__attribute__((target("avx2"))) inline size_t
+vigenereShiftAvx2(const char *in, const unsigned char *back, char *out,
+                  size_t size, unsigned char base, unsigned m) {
+  const __m256i vbase = _mm256_set1_epi8(static_cast<char>(base));
+  const __m256i vlast = _mm256_set1_epi8(static_cast<char>(m - 1));
+  const __m256i vm = _mm256_set1_epi8(static_cast<char>(m));
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i x = _mm256_sub_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)), vbase);
+    if (m < 256 &&
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(x, vlast),
+                                               vlast)) != -1) {
+      break;
+    }
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(back + i));
+    __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(x, b), x);
+    __m256i r = _mm256_add_epi8(_mm256_sub_epi8(x, b),
+                                _mm256_andnot_si256(ge, vm));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_add_epi8(r, vbase));
+  }
+  return i;
+}
+
+/**
+ * @brief Сдвиг по модулю m векторами AVX-512 по 64 байта
+ * @param in Входной текст
+ * @param back Для каждой позиции (m - сдвиг) mod 256, 1 <= m - сдвиг <= m
+ * @param out Результат (может совпадать с in)
+ * @param size Число байт
+ * @param base Код первого символа алфавита
+ * @param m Размер алфавита (base + m <= 256)
+ * @return Число обработанных байт (кратно 64)
+ */
+__attribute__((target("avx512bw"))) inline size_t
+vigenereShiftAvx512(const char *in, const unsigned char *back, char *out,
+                    size_t size, unsigned char base, unsigned m) {
+  const __m512i vbase = _mm512_set1_epi8(static_cast<char>(base));
+  const __m512i vlast = _mm512_set1_epi8(static_cast<char>(m - 1));
+  const __m512i vm = _mm512_set1_epi8(static_cast<char>(m));
+  size_t i = 0;
+  for (; i + 64 <= size; i += 64) {
+    __m512i x = _mm512_sub_epi8(_mm512_loadu_si512(in + i), vbase);
+    if (m < 256 && _mm512_cmpgt_epu8_mask(x, vlast) != 0) {
+      break;
+    }
+    __m512i b = _mm512_loadu_si512(back + i);
+    __mmask64 lt = _mm512_cmplt_epu8_mask(x, b);
+    __m512i r = _mm512_sub_epi8(x, b);
+    r = _mm512_mask_add_epi8(r, lt, r, vm);
+    _mm512_storeu_si512(out + i, _mm512_add_epi8(r, vbase));
+  }
+  return i;
+}
+#endif
+
+/**
+ * @brief Выбор векторного ядра Виженера для текущего процессора
+ * @return Указатель на ядро или nullptr, если векторных ядер нет
+ */
+inline VigenereKernel selectVigenereKernel() {
+  static const VigenereKernel kernel = []() -> VigenereKernel {
+#ifdef VIGENERE_SIMD_KERNEL
+    if (__builtin_cpu_supports("avx512bw")) {
+      return &vigenereShiftAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return &vigenereShiftAvx2;
+    }
+#endif
+    return nullptr;
+  }();
+  return kernel;
+}
+
+/**
+ * @class VigenereCipher
+ * @brief Шифр Виженера с ключом, повторяющимся по кругу
+ *
+ * Символ в позиции i потока сдвигается на символ ключа с номером
+ * i mod |ключа|, поэтому гамма не строится: номер символа ключа вычисляется
+ * на ходу, а результат пишется сразу в выходной буфер. Обработка с
+ * произвольного смещения позволяет делить длинный текст между потоками.
+ */
+class VigenereCipher : public CipherBase<VigenereCipher> {
+  friend class CipherBase<VigenereCipher>;
+
+  std::string alphabet;                   ///< Алфавит
+  std::array<int, 256> symbolIndex;       ///< Индекс символа в алфавите или -1
+  std::vector<int> keyShifts;             ///< Индексы символов ключа
+  std::vector<char> tabula;               ///< Таблица Виженера m x m или пустая
+  int contiguousBase = -1;                ///< Первый код непрерывного алфавита
+  std::vector<unsigned char> encryptBack; ///< m - сдвиг, развёрнутый по period
+  std::vector<unsigned char> decryptBack; ///< То же для расшифрования
+  size_t period = 0;                      ///< Участок векторной обработки
+
+  /// Наибольший алфавит, для которого строится таблица Виженера (16 КБ)
+  static constexpr size_t tabulaMaxAlphabet = 128;
+  /// Наибольший хвост, передаваемый табличному варианту за раз
+  static constexpr size_t tableChunk = 4096;
+  /// Нижняя граница period
+  static constexpr size_t minPeriod = 4096;
+
+  /**
+   * @brief Сдвиг участка текста на символы ключа через таблицы
+   * @param input Входной текст
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param offset Позиция input[0] в потоке
+   * @param decrypting true - вычитать ключ, false - прибавлять
+   * @details Для малых алфавитов результат берётся из строки таблицы
+   *          Виженера, соответствующей сдвигу; для больших - сложением
+   *          индексов с вычитанием m при переполнении
+   */
+  void transformTable(std::span<const char> input, std::span<char> output,
+                      size_t offset, bool decrypting) const {
+    int m = alphabet.size();
+    size_t phase = offset % keyShifts.size();
+    for (size_t i = 0; i < input.size(); ++i) {
+      int shift = keyShifts[phase];
+      if (decrypting && shift != 0) {
+        shift = m - shift;
+      }
+      int index = indexOf(input[i]);
+      if (!tabula.empty()) {
+        output[i] = tabula[shift * m + index];
+      } else {
+        index += shift;
+        output[i] = alphabet[index >= m ? index - m : index];
+      }
+      if (++phase == keyShifts.size()) {
+        phase = 0;
+      }
+    }
+  }
+
+  /**
+   * @brief Ядро шифра (см. CipherBase): сдвиг участка на символы ключа
+   * @param input Входной текст
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param direction Направление (расшифрование вычитает ключ)
+   * @param offset Позиция input[0] в потоке
+   * @return Длина результата
+   * @throw std::invalid_argument Если в тексте есть символ не из алфавита
+   * @details Для непрерывного алфавита текст обрабатывается векторным ядром
+   *          участками по period байт: участок с фазой ключа p берёт сдвиги
+   *          из развёрнутого массива начиная с p. Хвосты и блоки с символами
+   *          вне алфавита передаются табличному варианту
+   */
+  size_t transformImpl(std::span<const char> input, std::span<char> output,
+                       Direction direction, size_t offset) const {
+    bool decrypting = direction == Direction::Decrypt;
+    VigenereKernel kernel = selectVigenereKernel();
+    if (contiguousBase < 0 || kernel == nullptr) {
+      transformTable(input, output, offset, decrypting);
+      return input.size();
+    }
+    const std::vector<unsigned char> &back =
+        decrypting ? decryptBack : encryptBack;
+    size_t pos = 0;
+    while (pos < input.size()) {
+      size_t len = std::min(period, input.size() - pos);
+      size_t done = kernel(input.data() + pos,
+                           back.data() + (offset + pos) % keyShifts.size(),
+                           output.data() + pos, len, contiguousBase,
+                           alphabet.size());
+      if (done < len) {
+        // Остаток участка (или блок с ошибкой) - табличным способом
+        size_t rest = std::min(len - done, tableChunk);
+        transformTable(input.subspan(pos + done, rest),
+                       output.subspan(pos + done), offset + pos + done,
+                       decrypting);
+        done += rest;
+      }
+      pos += done;
+    }
+    return input.size();
+  }
+
+public:
+  static constexpr bool preservesLength = true; ///< Длина текста не меняется
+
+  /**
+   * @brief Конструктор шифра
+   * @param alph Алфавит
+   * @param k Ключ из символов алфавита
+   * @throw std::invalid_argument Если алфавит пустой, длиннее 256 символов
+   * или содержит повторы, ключ пустой либо в ключе есть символ не из алфавита
+   * @details Алфавит один раз переводится в таблицу индексов по байту, ключ -
+   *          в массив сдвигов; для алфавитов до 128 символов строится таблица
+   *          Виженера, и каждый символ шифруется двумя загрузками из таблиц.
+   *          Для алфавита из подряд идущих кодов (a-z, все байты) сдвиги
+   *          ключа разворачиваются в массив для векторного ядра
+   */
+  VigenereCipher(const std::string &alph, const std::string &k)
+      : alphabet(alph) {
+    if (alphabet.empty() || alphabet.size() > 256) {
+      throw std::invalid_argument(
+          "Алфавит должен содержать от 1 до 256 символов");
+    }
+    symbolIndex.fill(-1);
+    for (size_t i = 0; i < alphabet.size(); ++i) {
+      int &slot = symbolIndex[static_cast<unsigned char>(alphabet[i])];
+      if (slot != -1) {
+        throw std::invalid_argument("Алфавит содержит повторяющиеся символы");
+      }
+      slot = i;
+    }
+    if (k.empty()) {
+      throw std::invalid_argument("Ключ не может быть пустым");
+    }
+    for (char c : k) {
+      keyShifts.push_back(indexOf(c));
+    }
+
+    size_t m = alphabet.size();
+    contiguousBase = static_cast<unsigned char>(alphabet[0]);
+    for (size_t i = 0; i < m; ++i) {
+      if (static_cast<unsigned char>(alphabet[i]) != contiguousBase + i) {
+        contiguousBase = -1;
+        break;
+      }
+    }
+    if (contiguousBase >= 0) {
+      period = (minPeriod + k.size() - 1) / k.size() * k.size();
+      for (size_t i = 0; i < period + k.size(); ++i) {
+        int shift = keyShifts[i % k.size()];
+        encryptBack.push_back(static_cast<unsigned char>(m - shift));
+        decryptBack.push_back(
+            static_cast<unsigned char>(shift == 0 ? m : shift));
+      }
+    }
+    if (m <= tabulaMaxAlphabet) {
+      tabula.resize(m * m);
+      for (size_t row = 0; row < m; ++row) {
+        for (size_t column = 0; column < m; ++column) {
+          tabula[row * m + column] = alphabet[(row + column) % m];
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Номер символа в алфавите
+   * @param c Символ
+   * @return Номер символа
+   * @throw std::invalid_argument Если символа нет в алфавите
+   */
+  int indexOf(char c) const {
+    int index = symbolIndex[static_cast<unsigned char>(c)];
+    if (index < 0) {
+      throw std::invalid_argument(std::string("Символ '") + c +
+                                  "' отсутствует в алфавите");
+    }
+    return index;
+  }
+
+  /**
+   * @brief Входит ли символ в алфавит
+   * @param c Символ
+   * @return true, если символ шифруется
+   */
+  bool contains(char c) const {
+    return symbolIndex[static_cast<unsigned char>(c)] >= 0;
+  }
+
+  /**
+   * @brief Символ алфавита по номеру
+   * @param index Номер символа (от 0 до m - 1)
+   * @return Символ
+   */
+  char symbolAt(int index) const { return alphabet[index]; }
+
+  /**
+   * @brief Размер алфавита
+   * @return Число символов m
+   */
+  int alphabetSize() const { return alphabet.size(); }
+
+  /**
+   * @brief Ключ в виде номеров символов
+   * @return Номера символов ключа в алфавите
+   */
+  const std::vector<int> &keyIndices() const { return keyShifts; }
+
+  /**
+   * @brief Обработка на месте символов алфавита; остальные байты (пробелы,
+   * знаки препинания) остаются без изменений и не сдвигают ключ
+   * @param data Текст
+   * @param direction Направление
+   * @param offset Число символов алфавита, обработанных ранее в потоке
+   * @return Смещение после data (offset плюс число символов алфавита в data)
+   */
+  size_t transformLetters(std::span<char> data, Direction direction,
+                          size_t offset = 0) const {
+    size_t pos = 0;
+    while (pos < data.size()) {
+      size_t end = pos;
+      while (end < data.size() && contains(data[end])) {
+        ++end;
+      }
+      transformInPlace(data.subspan(pos, end - pos), direction, offset);
+      offset += end - pos;
+      while (end < data.size() && !contains(data[end])) {
+        ++end;
+      }
+      pos = end;
+    }
+    return offset;
+  }
+
+  /**
+   * @brief Шифрование буфера
+   * @param input Открытый текст
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param offset Позиция input[0] в потоке (определяет фазу ключа)
+   * @param pool Пул потоков для буферов от 1 МБ
+   * @throw std::invalid_argument Если выходной буфер короче входного или в
+   * тексте есть символ не из алфавита
+   */
+  void encrypt(std::span<const char> input, std::span<char> output,
+               size_t offset = 0,
+               ThreadPool &pool = ThreadPool::shared()) const {
+    transformParallel(input, output, Direction::Encrypt, offset, pool);
+  }
+
+  /**
+   * @brief Расшифрование буфера
+   * @param input Шифртекст
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @param offset Позиция input[0] в потоке (определяет фазу ключа)
+   * @param pool Пул потоков для буферов от 1 МБ
+   * @throw std::invalid_argument Если выходной буфер короче входного или в
+   * тексте есть символ не из алфавита
+   */
+  void decrypt(std::span<const char> input, std::span<char> output,
+               size_t offset = 0,
+               ThreadPool &pool = ThreadPool::shared()) const {
+    transformParallel(input, output, Direction::Decrypt, offset, pool);
+  }
+
+  /**
+   * @brief Шифрование строки
+   * @param plaintext Открытый текст
+   * @return Шифртекст
+   */
+  std::string encrypt(const std::string &plaintext) const {
+    std::string output(plaintext.size(), '\0');
+    encrypt(plaintext, output);
+    return output;
+  }
+
+  /**
+   * @brief Расшифрование строки
+   * @param ciphertext Шифртекст
+   * @return Открытый текст
+   */
+  std::string decrypt(const std::string &ciphertext) const {
+    std::string output(ciphertext.size(), '\0');
+    decrypt(ciphertext, output);
+    return output;
+  }
+};
+
+/**
+ * @class VigenereAutokey
+ * @brief Шифр Виженера с самоключом для потоков произвольной длины
+ *
+ * Гамма начинается с ключа шифра и продолжается самим открытым текстом:
+ * символ в позиции i >= |ключа| сдвигается на символ открытого текста в
+ * позиции i - |ключа|. Кольцевой буфер длины ключа сначала содержит ключ и
+ * по мере обработки заполняется открытым текстом, поэтому память не зависит
+ * от длины потока. Номера символов берутся из таблиц VigenereCipher.
+ */
+class VigenereAutokey {
+  const VigenereCipher &cipher; ///< Алфавит и ключ (должен жить дольше)
+  bool decrypting;              ///< true - расшифрование
+  std::vector<int> ring;        ///< Последние |ключа| символов открытого текста
+  size_t head = 0;              ///< Позиция следующего сдвига в ring
+
+  /// Размер буфера при обработке потоков ввода-вывода
+  static constexpr size_t bufferSize = 1 << 16;
+
+public:
+  /**
+   * @brief Конструктор потока
+   * @param c Шифр Виженера, задающий алфавит и начальный ключ
+   * @param decrypt true - расшифрование, false - шифрование
+   */
+  VigenereAutokey(const VigenereCipher &c, bool decrypt)
+      : cipher(c), decrypting(decrypt), ring(c.keyIndices()) {}
+
+  /**
+   * @brief Возврат к началу потока (гамма снова начинается с ключа)
+   */
+  void reset() {
+    ring = cipher.keyIndices();
+    head = 0;
+  }
+
+  /**
+   * @brief Обработка очередной части потока
+   * @param input Часть текста
+   * @param output Буфер не короче input (может совпадать с ним)
+   * @throw std::invalid_argument Если выходной буфер короче входного или в
+   * тексте есть символ не из алфавита (символы до него уже обработаны)
+   */
+  void update(std::span<const char> input, std::span<char> output) {
+    if (output.size() < input.size()) {
+      throw std::invalid_argument("Выходной буфер слишком мал");
+    }
+    int m = cipher.alphabetSize();
+    for (size_t i = 0; i < input.size(); ++i) {
+      int index = cipher.indexOf(input[i]);
+      int shift = ring[head];
+      int result = decrypting ? index - shift : index + shift;
+      if (result < 0) {
+        result += m;
+      } else if (result >= m) {
+        result -= m;
+      }
+      output[i] = cipher.symbolAt(result);
+      ring[head] = decrypting ? result : index;
+      if (++head == ring.size()) {
+        head = 0;
+      }
+    }
+  }
+
+  /**
+   * @brief Обработка всего потока ввода блоками постоянного размера
+   * @param in Входной поток
+   * @param out Выходной поток
+   * @throw std::invalid_argument Если в тексте есть символ не из алфавита
+   * @throw std::runtime_error При ошибке записи
+   */
+  void process(std::istream &in, std::ostream &out) {
+    std::vector<char> buffer(bufferSize);
+    while (in) {
+      in.read(buffer.data(), buffer.size());
+      std::span<char> chunk(buffer.data(), in.gcount());
+      update(chunk, chunk);
+      if (!out.write(chunk.data(), chunk.size())) {
+        throw std::runtime_error("Ошибка записи результата");
+      }
+    }
+  }
+};
+
 /**
  * @brief Главная функция для работы с шифром Виженера
  * @param alphabet Набор символов, которые можно шифровать (обычно буквы
@@ -55,8 +540,6 @@ string main_Vij(string alphabet_vvod, string key_text_vvod, string text_vvod,
   } else {
     alphabet = alphabet_vvod;
   }
-  /** @brief Размер алфавита - сколько всего символов можно использовать */
-  int m = alphabet.length();
 
   cout << "\nВведите ключ шифрования:" << endl;
   string key_text;
@@ -66,20 +549,22 @@ string main_Vij(string alphabet_vvod, string key_text_vvod, string text_vvod,
   } else {
     key_text = key_text_vvod;
   }
-  /** @brief Длина ключевого слова */
-  int len_key_text = key_text.length();
+  try {
+    /** @brief Шифр с введёнными алфавитом и ключом (из общего кэша) */
+    std::shared_ptr<const VigenereCipher> cipher =
+        cachedContext<VigenereCipher>({"vigenere", alphabet, key_text},
+                                      alphabet, key_text);
 
-  cout << "\nДля зашифрования нажмите -->" << endl;
-  cout << "Для расшифрования нажмите <--" << endl;
+    cout << "\nДля зашифрования нажмите -->" << endl;
+    cout << "Для расшифрования нажмите <--" << endl;
 
-  while (true) {
-    if (_kbhit() || mod != 0) {
+    while (true) {
       /** @brief Код нажатой стрелки (влево или вправо) */
-      int arrow;
-      if (mod == 0) {
-        arrow = _getch();
+      int arrow = mod == 0 ? readKey() : 0;
+      if (arrow == KeyEnd) {
+        break;
       }
-      if (arrow == 77 || mod == 1) {
+      if (arrow == KeyRight || mod == 1) {
         cout << "\nВведите открытый текст:" << endl;
         /** @brief Текст, который нужно зашифровать */
         string open_text;
@@ -92,34 +577,16 @@ string main_Vij(string alphabet_vvod, string key_text_vvod, string text_vvod,
         for (auto &c : open_text) {
           c = tolower(c);
         }
-        /** @brief Длина текста для шифрования */
-        int len_open_text = open_text.length();
-
-        /** @brief Гамма - ключевое слово, растянутое на всю длину текста */
-        string gamma_text;
-        for (int i = 0; i < len_open_text / len_key_text; ++i) {
-          gamma_text += key_text;
-        }
-        gamma_text += key_text.substr(0, len_open_text % len_key_text);
-
-        /** @brief Массив индексов зашифрованных символов */
-        vector<int> shifr_array(len_open_text);
-        for (int i = 0; i < len_open_text; ++i) {
-          shifr_array[i] =
-              (alphabet.find(open_text[i]) + alphabet.find(gamma_text[i])) % m;
-        }
-
-        /** @brief Итоговый зашифрованный текст */
-        string shifr_text = "";
-        for (int i : shifr_array) {
-          shifr_text += alphabet[i];
-        }
+        /** @brief Итоговый зашифрованный текст (символы вне алфавита не
+         * изменяются) */
+        string shifr_text = open_text;
+        cipher->transformLetters(shifr_text, Direction::Encrypt);
 
         cout << "\nШифртекст:" << endl;
         cout << shifr_text << endl;
         return shifr_text;
         break;
-      } else if (arrow == 75 || mod == 2) {
+      } else if (arrow == KeyLeft || mod == 2) {
         cout << "\nВведите шифртекст:" << endl;
         /** @brief Зашифрованный текст, который нужно расшифровать */
         string shifr_text;
@@ -128,30 +595,9 @@ string main_Vij(string alphabet_vvod, string key_text_vvod, string text_vvod,
         } else {
           shifr_text = text_vvod;
         }
-        /** @brief Длина зашифрованного текста */
-        int len_shifr_text = shifr_text.length();
-
-        /** @brief Гамма для расшифрования - то же ключевое слово, растянутое на
-         * длину текста */
-        string gamma_text;
-        for (int i = 0; i < len_shifr_text / len_key_text; ++i) {
-          gamma_text += key_text;
-        }
-        gamma_text += key_text.substr(0, len_shifr_text % len_key_text);
-
-        /** @brief Массив индексов расшифрованных символов */
-        vector<int> open_array(len_shifr_text);
-        for (int i = 0; i < len_shifr_text; ++i) {
-          open_array[i] = (alphabet.find(shifr_text[i]) -
-                           alphabet.find(gamma_text[i]) + m) %
-                          m;
-        }
-
         /** @brief Итоговый расшифрованный текст */
-        string open_text;
-        for (int i : open_array) {
-          open_text += alphabet[i];
-        }
+        string open_text = shifr_text;
+        cipher->transformLetters(open_text, Direction::Decrypt);
 
         cout << "\nОткрытый текст:" << endl;
         cout << open_text << endl;
@@ -159,8 +605,12 @@ string main_Vij(string alphabet_vvod, string key_text_vvod, string text_vvod,
         break;
       }
     }
+  } catch (exception &e) {
+    cout << "\nОшибка при проведении криптографической операции: " << e.what()
+         << endl;
+    cout << "Проверьте корректность введенных данных." << endl;
   }
 
-  return 0;
+  return "";
 }
 #endif
\ No newline at end of file
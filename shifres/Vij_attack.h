@@ -0,0 +1,554 @@
+/**
+ * @file vij_attack.h
+ * @brief Криптоанализ шифра Виженера
+ * @details Длина ключа оценивается методом Касиски (расстояния между
+ *          повторами триграмм) и индексом совпадений Фридмана по столбцам,
+ *          после чего каждый столбец решается как шифр Цезаря по критерию
+ *          хи-квадрат. Для ключей-слов есть перебор по словарю
+ */
+
+#ifndef VIJ_ATTACK_H
+#define VIJ_ATTACK_H
+
+#include "English.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Частоты символов алфавита по образцу текста
+ * @param reference Образец текста на языке открытого текста
+ * @param alphabet Алфавит
+ * @return Частоты символов алфавита (символы вне алфавита пропускаются,
+ * отсутствующие символы получают малую ненулевую частоту)
+ */
+inline std::vector<double> symbolFrequencies(const std::string &reference,
+                                             const std::string &alphabet) {
+  std::vector<int> index(256, -1);
+  for (size_t i = 0; i < alphabet.size(); ++i) {
+    index[static_cast<unsigned char>(alphabet[i])] = i;
+  }
+  std::vector<double> f(alphabet.size(), 0.01);
+  double sum = 0.01 * alphabet.size();
+  for (char c : reference) {
+    int i = index[static_cast<unsigned char>(c)];
+    if (i >= 0) {
+      f[i] += 1;
+      sum += 1;
+    }
+  }
+  for (double &v : f) {
+    v /= sum;
+  }
+  return f;
+}
+
+/**
+ * @brief Перевод шифртекста в индексы символов алфавита
+ * @param text Шифртекст
+ * @param alphabet Алфавит (до 256 символов)
+ * @return Индексы символов текста; символы вне алфавита пропускаются
+ * @throw std::invalid_argument Если алфавит пуст или длиннее 256 символов
+ */
+inline std::vector<unsigned char>
+vigenereIndices(const std::string &text, const std::string &alphabet) {
+  if (alphabet.empty() || alphabet.size() > 256) {
+    throw std::invalid_argument(
+        "Алфавит должен содержать от 1 до 256 символов");
+  }
+  std::vector<int> index(256, -1);
+  for (size_t i = 0; i < alphabet.size(); ++i) {
+    index[static_cast<unsigned char>(alphabet[i])] = i;
+  }
+  std::vector<unsigned char> result;
+  result.reserve(text.size());
+  for (char c : text) {
+    int i = index[static_cast<unsigned char>(c)];
+    if (i >= 0) {
+      result.push_back(static_cast<unsigned char>(i));
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Оценка длины ключа методом Касиски
+ * @param text Индексы символов шифртекста
+ * @param m Размер алфавита
+ * @param maxPeriod Наибольшая проверяемая длина ключа
+ * @param sampleSize Сколько первых символов использовать
+ * @return Для каждой длины p от 0 до maxPeriod - доля расстояний между
+ * повторами триграмм, кратных p, умноженная на p (около 1 для случайных
+ * длин, заметно больше для длины ключа и её кратных)
+ * @details Хеш-таблица хранит последнюю позицию каждой триграммы; для
+ *          каждого повтора проверяется делимость расстояния на все p
+ */
+inline std::vector<double>
+kasiskiScores(const std::vector<unsigned char> &text, size_t m,
+              size_t maxPeriod, size_t sampleSize = 1 << 18) {
+  std::vector<double> votes(maxPeriod + 1, 0);
+  std::unordered_map<uint32_t, uint32_t> lastSeen;
+  size_t n = std::min(text.size(), sampleSize);
+  size_t total = 0;
+  for (size_t i = 0; i + 2 < n; ++i) {
+    uint32_t trigram = (text[i] * m + text[i + 1]) * m + text[i + 2];
+    auto [it, inserted] = lastSeen.try_emplace(trigram, i);
+    if (inserted) {
+      continue;
+    }
+    size_t distance = i - it->second;
+    it->second = i;
+    ++total;
+    for (size_t p = 1; p <= maxPeriod; ++p) {
+      if (distance % p == 0) {
+        votes[p] += 1;
+      }
+    }
+  }
+  for (size_t p = 1; p <= maxPeriod && total > 0; ++p) {
+    votes[p] = votes[p] * p / total;
+  }
+  return votes;
+}
+
+/**
+ * @brief Гистограммы символов по столбцам (позиция mod period)
+ * @param text Индексы символов шифртекста
+ * @param m Размер алфавита
+ * @param period Число столбцов
+ * @return Счётчики period x m
+ * @details Символы считаются в четыре чередующихся набора счётчиков, чтобы
+ *          соседние одинаковые символы не упирались в зависимость
+ *          загрузки-сохранения одного счётчика, затем наборы складываются
+ */
+inline std::vector<uint32_t>
+columnHistograms(const std::vector<unsigned char> &text, size_t m,
+                 size_t period) {
+  size_t stride = period * m;
+  std::vector<uint32_t> counts(4 * stride, 0);
+  size_t column = 0;
+  size_t i = 0;
+  for (; i + 4 <= text.size(); i += 4) {
+    for (size_t lane = 0; lane < 4; ++lane) {
+      ++counts[lane * stride + column * m + text[i + lane]];
+      if (++column == period) {
+        column = 0;
+      }
+    }
+  }
+  for (; i < text.size(); ++i) {
+    ++counts[column * m + text[i]];
+    if (++column == period) {
+      column = 0;
+    }
+  }
+  for (size_t lane = 1; lane < 4; ++lane) {
+    for (size_t j = 0; j < stride; ++j) {
+      counts[j] += counts[lane * stride + j];
+    }
+  }
+  counts.resize(stride);
+  return counts;
+}
+
+/**
+ * @brief Оценка длины ключа Виженера
+ */
+struct VigenerePeriod {
+  size_t period;      ///< Длина ключа
+  double coincidence; ///< Средний индекс совпадений столбцов
+  double kasiski;     ///< Оценка Касиски (см. kasiskiScores)
+};
+
+/**
+ * @brief Ранжирование длин ключа
+ * @param text Индексы символов шифртекста
+ * @param m Размер алфавита
+ * @param maxPeriod Наибольшая проверяемая длина ключа
+ * @param pool Пул потоков, между которыми делятся длины
+ * @return Длины от 1 до maxPeriod, самая вероятная первой
+ * @details Для каждой длины p считается средний по столбцам индекс
+ *          совпадений (Фридман): при верной длине столбец зашифрован одним
+ *          сдвигом, и индекс близок к индексу языка, иначе - к 1/m. Оценка
+ *          длины - сумма превышений индекса над 1/m и оценки Касиски, каждое
+ *          нормировано на максимум. Кратные длины ключа получают почти ту же
+ *          оценку, поэтому первыми идут по возрастанию длины все, чья оценка
+ *          не ниже 85% наилучшей, а за ними остальные по убыванию оценки
+ */
+inline std::vector<VigenerePeriod>
+rankVigenerePeriods(const std::vector<unsigned char> &text, size_t m,
+                    size_t maxPeriod = 40,
+                    ThreadPool &pool = ThreadPool::shared()) {
+  maxPeriod = std::min(maxPeriod, text.size() / 2);
+  if (maxPeriod == 0) {
+    throw std::invalid_argument("Шифртекст слишком короткий");
+  }
+  std::vector<double> kasiski = kasiskiScores(text, m, maxPeriod);
+  std::vector<VigenerePeriod> result(maxPeriod);
+  pool.run([&](unsigned part) {
+    for (size_t p = 1 + part; p <= maxPeriod; p += pool.size()) {
+      std::vector<uint32_t> counts = columnHistograms(text, m, p);
+      double sum = 0;
+      for (size_t column = 0; column < p; ++column) {
+        double pairs = 0, total = 0;
+        for (size_t j = 0; j < m; ++j) {
+          double c = counts[column * m + j];
+          pairs += c * (c - 1);
+          total += c;
+        }
+        sum += total > 1 ? pairs / (total * (total - 1)) : 0;
+      }
+      result[p - 1] = {p, sum / p, kasiski[p]};
+    }
+  });
+
+  double maxExcess = 0, maxKasiski = 0;
+  for (const auto &r : result) {
+    maxExcess = std::max(maxExcess, r.coincidence - 1.0 / m);
+    maxKasiski = std::max(maxKasiski, r.kasiski);
+  }
+  auto score = [&](const VigenerePeriod &r) {
+    double s = maxExcess > 0 ? (r.coincidence - 1.0 / m) / maxExcess : 0;
+    return s + (maxKasiski > 0 ? r.kasiski / maxKasiski : 0);
+  };
+  double best = 0;
+  for (const auto &r : result) {
+    best = std::max(best, score(r));
+  }
+  std::sort(result.begin(), result.end(),
+            [&](const VigenerePeriod &a, const VigenerePeriod &b) {
+              bool topA = score(a) >= 0.85 * best;
+              bool topB = score(b) >= 0.85 * best;
+              if (topA != topB) {
+                return topA;
+              }
+              return topA ? a.period < b.period : score(a) > score(b);
+            });
+  return result;
+}
+
+/**
+ * @brief Ключ-кандидат шифра Виженера
+ */
+struct VigenereKeyCandidate {
+  std::string key;   ///< Ключ
+  double chiSquared; ///< Средний по столбцам критерий хи-квадрат
+};
+
+/**
+ * @brief Подбор ключа известной длины по столбцам
+ * @param text Индексы символов шифртекста
+ * @param alphabet Алфавит
+ * @param period Длина ключа
+ * @param frequencies Частоты символов алфавита в открытом тексте
+ * @return Ключ и его средний критерий хи-квадрат
+ * @details Для каждого столбца выбирается сдвиг s, при котором частоты
+ *          расшифрованных символов ближе всего к частотам языка:
+ *          минимум суммы (count[j + s] - N f[j])^2 / (N f[j])
+ */
+inline VigenereKeyCandidate
+solveVigenereKey(const std::vector<unsigned char> &text,
+                 const std::string &alphabet, size_t period,
+                 const std::vector<double> &frequencies) {
+  size_t m = alphabet.size();
+  if (frequencies.size() != m) {
+    throw std::invalid_argument(
+        "Число частот не совпадает с размером алфавита");
+  }
+  std::vector<uint32_t> counts = columnHistograms(text, m, period);
+  VigenereKeyCandidate result{std::string(period, alphabet[0]), 0};
+  for (size_t column = 0; column < period; ++column) {
+    const uint32_t *c = &counts[column * m];
+    double total = 0;
+    for (size_t j = 0; j < m; ++j) {
+      total += c[j];
+    }
+    double bestChi = INFINITY;
+    for (size_t s = 0; s < m; ++s) {
+      double chi = 0;
+      for (size_t j = 0; j < m; ++j) {
+        double expected = total * frequencies[j];
+        double diff = c[(j + s) % m] - expected;
+        chi += diff * diff / expected;
+      }
+      if (chi < bestChi) {
+        bestChi = chi;
+        result.key[column] = alphabet[s];
+      }
+    }
+    result.chiSquared += bestChi / period;
+  }
+  return result;
+}
+
+/**
+ * @brief Вскрытие шифра Виженера только по шифртексту
+ * @param ciphertext Шифртекст (символы вне алфавита пропускаются)
+ * @param alphabet Алфавит
+ * @param frequencies Частоты символов алфавита в открытом тексте
+ * @param maxPeriod Наибольшая проверяемая длина ключа
+ * @param candidates Сколько лучших длин ключа решать
+ * @param pool Пул потоков
+ * @return Ключи-кандидаты в порядке ранжирования длин
+ * @throw std::invalid_argument Если шифртекст слишком короткий или частоты
+ * не соответствуют алфавиту
+ * @details Ключи, являющиеся повторением уже найденного более короткого
+ *          ключа, не выводятся
+ */
+inline std::vector<VigenereKeyCandidate>
+breakVigenere(const std::string &ciphertext, const std::string &alphabet,
+              const std::vector<double> &frequencies, size_t maxPeriod = 40,
+              size_t candidates = 3, ThreadPool &pool = ThreadPool::shared()) {
+  std::vector<unsigned char> text = vigenereIndices(ciphertext, alphabet);
+  std::vector<VigenerePeriod> periods =
+      rankVigenerePeriods(text, alphabet.size(), maxPeriod, pool);
+  std::vector<VigenereKeyCandidate> result;
+  for (const VigenerePeriod &p : periods) {
+    if (result.size() == candidates) {
+      break;
+    }
+    VigenereKeyCandidate candidate =
+        solveVigenereKey(text, alphabet, p.period, frequencies);
+    bool repeated = false;
+    for (const auto &found : result) {
+      size_t len = found.key.size();
+      if (candidate.key.size() % len == 0) {
+        repeated = true;
+        for (size_t i = 0; i < candidate.key.size() && repeated; ++i) {
+          repeated = candidate.key[i] == found.key[i % len];
+        }
+      }
+      if (repeated) {
+        break;
+      }
+    }
+    if (!repeated) {
+      result.push_back(candidate);
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Ключ, найденный перебором по словарю
+ */
+struct VigenereDictionaryMatch {
+  std::string key; ///< Слово-ключ
+  double score;    ///< Средний логарифм частоты символа открытого текста
+};
+
+/**
+ * @brief Перебор ключей Виженера по словарю в памяти
+ * @param ciphertext Шифртекст (символы вне алфавита пропускаются)
+ * @param wordlist Слова, по одному в строке
+ * @param alphabet Алфавит
+ * @param frequencies Частоты символов алфавита в открытом тексте
+ * @param topK Сколько лучших ключей вернуть
+ * @param pool Пул потоков
+ * @param prefixLength Длина начала шифртекста для отсева
+ * @return До topK ключей по убыванию оценки на всём шифртексте
+ * @throw std::invalid_argument Если шифртекст пуст или частоты не
+ * соответствуют алфавиту
+ * @details Оценка ключа - средний логарифм частоты расшифрованного символа.
+ *          Для начала шифртекста заранее считаются суммы по столбцам: для
+ *          каждой длины ключа L, столбца j и символа ключа s - сумма по
+ *          позициям i = j (mod L). Тогда оценка слова на начале текста - L
+ *          загрузок из таблицы. Слова с оценкой ниже середины между
+ *          ожидаемой для языка и для случайного текста отбрасываются,
+ *          остальные оцениваются на всём шифртексте. Потоки берут участки
+ *          словаря через атомарный счётчик без блокировок, у каждого свои
+ *          лучшие ключи, которые сливаются в конце
+ */
+inline std::vector<VigenereDictionaryMatch> searchVigenereDictionary(
+    const std::string &ciphertext, std::string_view wordlist,
+    const std::string &alphabet, const std::vector<double> &frequencies,
+    size_t topK = 10, ThreadPool &pool = ThreadPool::shared(),
+    size_t prefixLength = 256) {
+  std::vector<unsigned char> text = vigenereIndices(ciphertext, alphabet);
+  size_t m = alphabet.size();
+  if (text.empty()) {
+    throw std::invalid_argument("Шифртекст слишком короткий");
+  }
+  if (frequencies.size() != m) {
+    throw std::invalid_argument(
+        "Число частот не совпадает с размером алфавита");
+  }
+  std::vector<int> index(256, -1);
+  for (size_t i = 0; i < m; ++i) {
+    index[static_cast<unsigned char>(alphabet[i])] = i;
+  }
+
+  // logShifted[s * m + c] - логарифм частоты символа c, расшифрованного
+  // символом ключа s
+  std::vector<float> logShifted(m * m);
+  double language = 0, random = 0;
+  for (size_t j = 0; j < m; ++j) {
+    language += frequencies[j] * std::log(frequencies[j]);
+    random += std::log(frequencies[j]) / m;
+  }
+  for (size_t s = 0; s < m; ++s) {
+    for (size_t c = 0; c < m; ++c) {
+      logShifted[s * m + c] = std::log(frequencies[(c + m - s) % m]);
+    }
+  }
+  double threshold = (language + random) / 2;
+
+  // Суммы по столбцам начала текста для ключей длины до maxTableLength
+  constexpr size_t maxTableLength = 64;
+  size_t prefix = std::min(prefixLength, text.size());
+  std::vector<std::vector<float>> columns(maxTableLength + 1);
+  for (size_t length = 1; length <= maxTableLength; ++length) {
+    columns[length].assign(length * m, 0);
+    for (size_t i = 0; i < prefix; ++i) {
+      float *row = &columns[length][(i % length) * m];
+      for (size_t s = 0; s < m; ++s) {
+        row[s] += logShifted[s * m + text[i]];
+      }
+    }
+  }
+
+  auto fullScore = [&](const std::vector<unsigned char> &key) {
+    double sum = 0;
+    size_t j = 0;
+    for (unsigned char c : text) {
+      sum += logShifted[key[j] * m + c];
+      if (++j == key.size()) {
+        j = 0;
+      }
+    }
+    return sum / text.size();
+  };
+
+  // Порядок кандидатов: по убыванию оценки, при равенстве - по ключу, чтобы
+  // результат не зависел от распределения словаря между потоками
+  auto better = [](const VigenereDictionaryMatch &a,
+                   const VigenereDictionaryMatch &b) {
+    return a.score != b.score ? a.score > b.score : a.key < b.key;
+  };
+
+  constexpr size_t block = 1 << 16;
+  std::atomic<size_t> cursor{0};
+  std::vector<std::vector<VigenereDictionaryMatch>> best(pool.size());
+  pool.run([&](unsigned part) {
+    std::vector<VigenereDictionaryMatch> &mine = best[part];
+    std::vector<unsigned char> key;
+    // Куча с худшим кандидатом в вершине; повторы слова в словаре не
+    // занимают несколько мест
+    auto keep = [&](VigenereDictionaryMatch match) {
+      for (const auto &kept : mine) {
+        if (kept.key == match.key) {
+          return;
+        }
+      }
+      if (mine.size() < topK) {
+        mine.push_back(std::move(match));
+        std::push_heap(mine.begin(), mine.end(), better);
+      } else if (!mine.empty() && better(match, mine.front())) {
+        std::pop_heap(mine.begin(), mine.end(), better);
+        mine.back() = std::move(match);
+        std::push_heap(mine.begin(), mine.end(), better);
+      }
+    };
+    while (true) {
+      size_t begin = cursor.fetch_add(block, std::memory_order_relaxed);
+      if (begin >= wordlist.size()) {
+        break;
+      }
+      size_t end = std::min(wordlist.size(), begin + block);
+      // Строка, начатая в предыдущем участке, принадлежит ему
+      if (begin > 0 && wordlist[begin - 1] != '\n') {
+        size_t next = wordlist.find('\n', begin);
+        begin = next == std::string_view::npos ? wordlist.size() : next + 1;
+      }
+      while (begin < end) {
+        size_t next = wordlist.find('\n', begin);
+        size_t lineEnd =
+            next == std::string_view::npos ? wordlist.size() : next;
+        std::string_view word = wordlist.substr(begin, lineEnd - begin);
+        begin = lineEnd + 1;
+        if (!word.empty() && word.back() == '\r') {
+          word.remove_suffix(1);
+        }
+        if (word.empty()) {
+          continue;
+        }
+        key.clear();
+        for (char c : word) {
+          int i = index[static_cast<unsigned char>(c)];
+          if (i < 0) {
+            break;
+          }
+          key.push_back(static_cast<unsigned char>(i));
+        }
+        if (key.size() != word.size()) {
+          continue;
+        }
+        double score = 0;
+        if (key.size() <= maxTableLength) {
+          const float *table = columns[key.size()].data();
+          for (size_t j = 0; j < key.size(); ++j) {
+            score += table[j * m + key[j]];
+          }
+        } else {
+          for (size_t i = 0; i < prefix; ++i) {
+            score += logShifted[key[i % key.size()] * m + text[i]];
+          }
+        }
+        if (score < threshold * prefix) {
+          continue;
+        }
+        keep({std::string(word), fullScore(key)});
+      }
+    }
+  });
+
+  std::vector<VigenereDictionaryMatch> result;
+  std::unordered_set<std::string> seen;
+  for (const auto &matches : best) {
+    for (const auto &match : matches) {
+      if (seen.insert(match.key).second) {
+        result.push_back(match);
+      }
+    }
+  }
+  std::sort(result.begin(), result.end(), better);
+  if (result.size() > topK) {
+    result.resize(topK);
+  }
+  return result;
+}
+
+/**
+ * @brief Перебор ключей Виженера по файлу словаря
+ * @param ciphertext Шифртекст (символы вне алфавита пропускаются)
+ * @param wordlistPath Файл словаря, по слову в строке
+ * @param alphabet Алфавит
+ * @param frequencies Частоты символов алфавита в открытом тексте
+ * @param topK Сколько лучших ключей вернуть
+ * @param pool Пул потоков
+ * @return До topK ключей по убыванию оценки
+ * @throw std::runtime_error Если словарь не открывается
+ * @details Словарь отображается в память и читается потоками напрямую
+ */
+inline std::vector<VigenereDictionaryMatch> searchVigenereDictionaryFile(
+    const std::string &ciphertext, const std::string &wordlistPath,
+    const std::string &alphabet, const std::vector<double> &frequencies,
+    size_t topK = 10, ThreadPool &pool = ThreadPool::shared()) {
+  MappedFile wordlist(wordlistPath, false);
+  return searchVigenereDictionary(
+      ciphertext,
+      std::string_view(reinterpret_cast<const char *>(wordlist.bytes()),
+                       wordlist.size()),
+      alphabet, frequencies, topK, pool);
+}
+
+#endif // VIJ_ATTACK_H
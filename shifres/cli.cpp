@@ -0,0 +1,27 @@
+/**
+ * @file cli.cpp
+ * @brief Неинтерактивная программа для работы с шифрами
+ * @details Параметры задаются флагами командной строки (см. cli.h), текст
+ *          читается из файла или стандартного ввода, результат пишется в
+ *          файл или стандартный вывод без каких-либо пояснений. Шифры,
+ *          сохраняющие длину текста, работают как фильтр на дескрипторах
+ *          (`cat file | shifres -c subst -k ... > out`)
+ */
+
+#include "Cli.h"
+#include <iostream>
+#include <unistd.h>
+
+/**
+ * @brief Точка входа
+ * @param argc Число аргументов
+ * @param argv Аргументы командной строки
+ * @return 0 при успехе, 2 при ошибке в параметрах, 1 при прочих ошибках
+ */
+int main(int argc, char **argv) {
+  if (isCliFilter(argc, argv)) {
+    return runCliFilter(argc, argv, STDIN_FILENO, STDOUT_FILENO, std::cerr);
+  }
+  std::ios::sync_with_stdio(false);
+  return runCli(argc, argv, std::cin, std::cout, std::cerr);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file daemon.cpp
+ * @brief Сервер шифрования shifres-daemon
+ * @details Запуск: `shifres-daemon -s СОКЕТ -k ФАЙЛ_КЛЮЧЕЙ [-w ПОТОКИ]`.
+ *          Формат запросов и файла ключей описан в daemon.h. Сервер
+ *          завершается по SIGINT или SIGTERM и удаляет файл сокета
+ */
+
+#include "Daemon.h"
+#include <charconv>
+#include <csignal>
+#include <exception>
+#include <iostream>
+#include <pthread.h>
+#include <string_view>
+#include <thread>
+
+/// Справка по параметрам сервера
+static const char *const daemonUsage =
+    "Использование: shifres-daemon -s СОКЕТ -k ФАЙЛ_КЛЮЧЕЙ [-w ПОТОКИ]\n"
+    "  -s, --socket   путь Unix-сокета\n"
+    "  -k, --keys     файл ключей: строки \"номер<TAB>ключ[<TAB>алфавит]\"\n"
+    "  -w, --workers  число рабочих потоков (по умолчанию по числу ядер)\n";
+
+/**
+ * @brief Точка входа
+ * @param argc Число аргументов
+ * @param argv Аргументы командной строки
+ * @return 0 после остановки по сигналу, 2 при ошибке в параметрах, 1 при
+ * прочих ошибках
+ */
+int main(int argc, char **argv) {
+  std::string socketPath, keysPath;
+  unsigned workers = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string flag = argv[i];
+    if (i + 1 >= argc) {
+      std::cerr << daemonUsage;
+      return 2;
+    }
+    if (flag == "-s" || flag == "--socket") {
+      socketPath = argv[++i];
+    } else if (flag == "-k" || flag == "--keys") {
+      keysPath = argv[++i];
+    } else if (flag == "-w" || flag == "--workers") {
+      std::string_view value = argv[++i];
+      auto [last, error] = std::from_chars(
+          value.data(), value.data() + value.size(), workers);
+      if (value.empty() || error != std::errc() ||
+          last != value.data() + value.size()) {
+        std::cerr << "shifres-daemon: некорректное число потоков: " << value
+                  << '\n'
+                  << daemonUsage;
+        return 2;
+      }
+    } else {
+      std::cerr << daemonUsage;
+      return 2;
+    }
+  }
+  if (socketPath.empty() || keysPath.empty()) {
+    std::cerr << daemonUsage;
+    return 2;
+  }
+
+  // Сигналы блокируются до создания потоков и принимаются sigwait
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  try {
+    DaemonKeyStore keys;
+    keys.load(keysPath);
+    DaemonServer server(socketPath, keys, workers);
+    std::thread waiter([&] {
+      int signal;
+      sigwait(&signals, &signal);
+      server.stop();
+    });
+    std::exception_ptr failure;
+    try {
+      server.run();
+    } catch (...) {
+      failure = std::current_exception();
+      pthread_kill(waiter.native_handle(), SIGTERM);
+    }
+    waiter.join();
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "shifres-daemon: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -7,12 +7,12 @@
  */
 
 #include "Affin_Shifr.h"
+#include "Console.h"
 #include "Hill.h"
 #include "RSA.h"
 #include "Simple_sub.h"
 #include "Vernam.h"
 #include "Vij.h"
-#include <conio.h>
 #include <iostream>
 #include <limits>
 
@@ -43,53 +43,65 @@ int main() {
 
   int flag = 1;
   while (true) {
-    if (_kbhit()) {
-      int num = _getch();
-      if (num == 27) {
-        break;
+    int num = readKey();
+    if (num == KeyEscape || num == KeyEnd) {
+      break;
+    }
+    if (flag == 1) {
+      if (num == 49) {
+        std::cout << "\n";
+        flag = 0;
+        main_Aff("-1", "-1", "-1", 0);
       }
-      if (flag == 1) {
-        if (num == 49) {
-          std::cout << "\n";
-          flag = 0;
-          main_Aff("-1", "-1", "-1", 0);
-        }
-        if (num == 50) {
-          std::cout << "\n";
-          flag = 0;
-          main_Vij("-1", "-1", "-1", 0);
-        }
-        if (num == 51) {
-          std::cout << "\n";
-          flag = 0;
-          main_RSA("-1", -1, -1, 0);
-        }
-        if (num == 52) {
-          std::cout << "\n";
-          flag = 0;
-          string key, text;
-          cout
-              << "Введите ключ для шифра простой замены (26 уникальных букв): ";
-          getline(cin, key);
-          cout << "Введите текст для шифрования: ";
-          getline(cin, text);
+      if (num == 50) {
+        std::cout << "\n";
+        flag = 0;
+        main_Vij("-1", "-1", "-1", 0);
+      }
+      if (num == 51) {
+        std::cout << "\n";
+        flag = 0;
+        main_RSA("-1", -1, -1, 0);
+      }
+      if (num == 52) {
+        std::cout << "\n";
+        flag = 0;
+        string key, text;
+        cout << "Введите ключ для шифра простой замены (26 уникальных букв): ";
+        getline(cin, key);
+        cout << "Введите текст для шифрования: ";
+        getline(cin, text);
 
-          SimpleSubstitution cipher(key);
-          string encrypted = cipher.encrypt(text);
-          string decrypted = cipher.decrypt(encrypted);
+        SimpleSubstitution cipher(key);
+        string encrypted = cipher.encrypt(text);
+        string decrypted = cipher.decrypt(encrypted);
 
-          cout << "Зашифрованный текст: " << encrypted << endl;
-          cout << "Расшифрованный текст: " << decrypted << endl;
+        cout << "Зашифрованный текст: " << encrypted << endl;
+        cout << "Расшифрованный текст: " << decrypted << endl;
+      }
+      if (num == 53) {
+        std::cout << "\n";
+        flag = 0;
+        int size = 0;
+        cout << "Введите размер ключевой матрицы для шифра Хилла: ";
+        while (!(cin >> size) || size < 1) {
+          if (cin.eof()) {
+            return 0;
+          }
+          cin.clear();
+          cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+          cout << "Размер должен быть целым числом не меньше 1: ";
         }
-        if (num == 53) {
-          std::cout << "\n";
-          flag = 0;
-          vector<vector<int>> key(2, vector<int>(2));
-          cout << "Введите ключевую матрицу 2x2 для шифра Хилла (4 целых числа "
-                  "через пробел): ";
-          for (int i = 0; i < 2; ++i) {
-            for (int j = 0; j < 2; ++j) {
-              cin >> key[i][j];
+        try {
+          vector<vector<int>> key(size, vector<int>(size));
+          cout << "Введите ключевую матрицу " << size << "x" << size
+               << " (целые числа через пробел, по строкам): ";
+          for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+              if (!(cin >> key[i][j])) {
+                throw std::invalid_argument(
+                    "Элементы матрицы должны быть целыми числами");
+              }
             }
           }
           cin.ignore();
@@ -104,23 +116,31 @@ int main() {
 
           cout << "Зашифрованный текст: " << encrypted << endl;
           cout << "Расшифрованный текст: " << decrypted << endl;
+        } catch (exception &e) {
+          if (cin.fail() && !cin.eof()) {
+            cin.clear();
+            cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+          }
+          cout << "\nОшибка при проведении криптографической операции: "
+               << e.what() << endl;
+          cout << "Проверьте корректность введенных данных." << endl;
         }
-        if (num == 54) {
-          std::cout << "\n";
-          flag = 0;
-          string key, text;
-          cout << "Введите ключ для шифра Вернама: ";
-          getline(cin, key);
-          cout << "Введите текст для шифрования: ";
-          getline(cin, text);
+      }
+      if (num == 54) {
+        std::cout << "\n";
+        flag = 0;
+        string key, text;
+        cout << "Введите ключ для шифра Вернама: ";
+        getline(cin, key);
+        cout << "Введите текст для шифрования: ";
+        getline(cin, text);
 
-          VernamCipher cipher(key);
-          string encrypted = cipher.encrypt(text);
-          string decrypted = cipher.decrypt(encrypted);
+        VernamCipher cipher(key);
+        string encrypted = cipher.encrypt(text);
+        string decrypted = cipher.decrypt(encrypted);
 
-          cout << "Зашифрованный текст: " << encrypted << endl;
-          cout << "Расшифрованный текст: " << decrypted << endl;
-        }
+        cout << "Зашифрованный текст: " << encrypted << endl;
+        cout << "Расшифрованный текст: " << decrypted << endl;
       }
     }
   }
@@ -8,12 +8,39 @@
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "Affin_Shifr.h"
+#include "Cipher.h"
+#include "Cli.h"
+#include "ContextCache.h"
+#include "Daemon.h"
 #include "Hill.h"
+#include "Hill_attack.h"
+#include "Pipeline.h"
 #include "RSA.h"
 #include "Simple_sub.h"
+#include "ThreadPool.h"
 #include "Vernam.h"
+#include "Vernam_attack.h"
+#include "Vernam_pad.h"
 #include "Vij.h"
+#include "Vij_attack.h"
 #include "doctest.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+/**
+ * @brief Путь во временном каталоге, уникальный для запуска тестов
+ * @param name Основа имени
+ * @param extension Расширение (например, ".sock")
+ * @return Путь с номером процесса: одновременные запуски не мешают друг другу
+ */
+static std::filesystem::path uniqueTempPath(const std::string &name,
+                                            const std::string &extension = "") {
+  return std::filesystem::temp_directory_path() /
+         (name + "_" + std::to_string(getpid()) + extension);
+}
 
 /**
  * @brief Тестирование аффинного шифра
@@ -50,6 +77,12 @@ TEST_CASE("Testing Vij functions") {
    * "helloworld" */
   CHECK(main_Vij("abcdefghijklmnopqrstuvwxyz", "rus", "yydciofldu", 2) ==
         "helloworld");
+
+  /** @brief Символы вне алфавита не изменяются и не сдвигают ключ */
+  CHECK(main_Vij("abcdefghijklmnopqrstuvwxyz", "rus", "hello world", 1) ==
+        "yydci ofldu");
+  /** @brief Некорректный ключ - сообщение об ошибке, а не аварийный выход */
+  CHECK(main_Vij("abcdefghijklmnopqrstuvwxyz", "r s", "hello", 1) == "");
 }
 
 /**
@@ -65,6 +98,13 @@ TEST_CASE("Testing RSA functions") {
 
   /** @brief Проверка расшифрования: 4051753 должно вернуться к 111111 */
   CHECK(main_RSA("3557 2579", 3, 4051753, 2) == 111111);
+
+  /** @brief Составные и совпадающие множители дают неверную функцию Эйлера
+   * и отвергаются */
+  CHECK_THROWS_AS(RsaKey(61, 55, 7), std::invalid_argument);
+  CHECK_THROWS_AS(RsaKey(3599, 53, 7), std::invalid_argument);
+  CHECK_THROWS_AS(RsaKey(61, 61, 7), std::invalid_argument);
+  CHECK(RsaKey(61, 53, 17).d == 2753);
 }
 
 /**
@@ -110,4 +150,1093 @@ TEST_CASE("Testing VernamCipher functions") {
   std::string encrypted = vernam.encrypt("test");
   /** @brief Проверка полного цикла шифрования-дешифрования */
   CHECK(vernam.decrypt(encrypted) == "test");
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Тестирование шифра Хилла с матрицами больше 2x2
+ * @details Проверяем обращение матриц методом Гаусса-Жордана:
+ *          - Классический пример 3x3: "act" должно стать "poh"
+ *          - Матрица 2x2, в первом столбце которой нет обратимых по модулю 26
+ *            элементов, всё равно корректно обращается
+ *          - Необратимая матрица отвергается
+ */
+TEST_CASE("Testing HillCipher NxN keys") {
+  HillCipher hill3({{6, 24, 1}, {13, 16, 10}, {20, 17, 15}});
+  /** @brief Проверка шифрования: "act" должно стать "poh" */
+  CHECK(hill3.encrypt("act") == "poh");
+  /** @brief Проверка расшифрования: "poh" должно вернуться к "act" */
+  CHECK(hill3.decrypt("poh") == "act");
+
+  HillCipher noUnitPivot({{2, 1}, {13, 1}});
+  /** @brief Проверка полного цикла без обратимого ведущего элемента */
+  CHECK(noUnitPivot.decrypt(noUnitPivot.encrypt("attackatdawn")) ==
+        "attackatdawn");
+
+  /** @brief Определитель 2 необратим по модулю 26 */
+  CHECK_THROWS_AS(HillCipher({{2, 0}, {0, 1}}), std::runtime_error);
+}
+
+/**
+ * @brief Тестирование шифра Хилла с произвольным алфавитом
+ * @details Проверяем настраиваемый модуль:
+ *          - Редукция Барретта совпадает с обычным остатком
+ *          - Алфавит из 27 символов (с пробелом) сохраняет пробелы
+ *          - Алфавит из всех 256 байт (модуль - степень двойки) шифрует
+ *            двоичные данные
+ */
+TEST_CASE("Testing HillCipher custom alphabets") {
+  for (uint32_t m : {2u, 26u, 27u, 33u, 255u, 256u}) {
+    ModReducer reducer(m);
+    for (uint32_t x : {0u, 1u, m - 1, m, 12345u, 4294967295u}) {
+      /** @brief Проверка редукции по модулю m */
+      CHECK(reducer.reduce(x) == x % m);
+    }
+  }
+
+  HillCipher spaced({{5, 8}, {17, 3}}, "abcdefghijklmnopqrstuvwxyz ");
+  /** @brief Проверка полного цикла с пробелом в алфавите */
+  CHECK(spaced.decrypt(spaced.encrypt("hello world")) == "hello worldx");
+
+  std::string bytes;
+  for (int i = 0; i < 256; ++i) {
+    bytes += static_cast<char>(i);
+  }
+  HillCipher binary({{5, 8}, {17, 3}}, bytes);
+  /** @brief Проверка полного цикла на всех значениях байта */
+  CHECK(binary.decrypt(binary.encrypt(bytes)) == bytes);
+
+  /** @brief Повторяющиеся символы алфавита отвергаются */
+  CHECK_THROWS_AS(HillCipher({{3, 3}, {2, 5}}, "abca"), std::invalid_argument);
+}
+
+/**
+ * @brief Тестирование таблицы биграмм шифра Хилла 2x2
+ * @details Ключ 2x2 обрабатывается по таблице биграмм, а блочно-диагональная
+ *          матрица 4x4 из двух его копий - общим умножением на матрицу; на
+ *          тексте из всех биграмм алфавита с пробелом результаты шифрования
+ *          и расшифрования должны совпадать
+ */
+TEST_CASE("Testing HillCipher digraph table") {
+  std::string alphabet = "abcdefghijklmnopqrstuvwxyz ";
+  HillCipher pairs({{5, 8}, {17, 3}}, alphabet);
+  HillCipher blocks(
+      {{5, 8, 0, 0}, {17, 3, 0, 0}, {0, 0, 5, 8}, {0, 0, 17, 3}}, alphabet);
+  std::string text;
+  for (char first : alphabet) {
+    for (char second : alphabet) {
+      text += first;
+      text += second;
+    }
+  }
+  text += text; // длина кратна 4
+  /** @brief Шифрование по таблице совпадает с умножением на матрицу */
+  CHECK(pairs.encrypt(text) == blocks.encrypt(text));
+  /** @brief Расшифрование по таблице совпадает с умножением на матрицу */
+  CHECK(pairs.decrypt(text) == blocks.decrypt(text));
+}
+
+/**
+ * @brief Тестирование пакетного шифрования Хилла на длинных текстах
+ * @details Блоки шифруются независимо, поэтому повторённый 1000 раз блок
+ *          "act" должен дать повторённый 1000 раз "poh" - так проверяется
+ *          векторный путь, обрабатывающий текст тайлами. Для ключей разных
+ *          размеров и алфавитов из 26 и 256 символов непериодический текст
+ *          длиннее нескольких тайлов сравнивается с поблочным умножением
+ */
+TEST_CASE("Testing HillCipher batched blocks") {
+  HillCipher hill3({{6, 24, 1}, {13, 16, 10}, {20, 17, 15}});
+  std::string open_text, shifr_text;
+  for (int i = 0; i < 1000; ++i) {
+    open_text += "act";
+    shifr_text += "poh";
+  }
+  /** @brief Проверка шифрования длинного текста */
+  CHECK(hill3.encrypt(open_text) == shifr_text);
+  /** @brief Проверка расшифрования длинного текста */
+  CHECK(hill3.decrypt(shifr_text) == open_text);
+
+  std::string bytes;
+  for (int i = 0; i < 256; ++i) {
+    bytes += static_cast<char>(i);
+  }
+  unsigned seed = 7;
+  auto next = [&seed] {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+  };
+  for (const std::string &alphabet :
+       {std::string("abcdefghijklmnopqrstuvwxyz"), bytes}) {
+    int m = alphabet.size();
+    for (int n : {2, 3, 4, 5, 8, 16}) {
+      // Ключ L*U с единицами на диагоналях обратим при любом модуле
+      std::vector<std::vector<int>> lower(n, std::vector<int>(n, 0));
+      std::vector<std::vector<int>> upper = lower, key = lower;
+      for (int i = 0; i < n; ++i) {
+        lower[i][i] = upper[i][i] = 1;
+        for (int j = 0; j < i; ++j) {
+          lower[i][j] = next() % m;
+          upper[j][i] = next() % m;
+        }
+      }
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+          for (int k = 0; k < n; ++k) {
+            key[i][j] = (key[i][j] + lower[i][k] * upper[k][j]) % m;
+          }
+        }
+      }
+      HillCipher hill(key, alphabet);
+
+      // Непериодический текст на несколько тайлов и поблочный эталон
+      std::string text((3 * 4096 / n + 100) * n, '\0');
+      for (char &c : text) {
+        c = alphabet[next() % m];
+      }
+      std::string expected = text;
+      for (size_t start = 0; start < text.size(); start += n) {
+        for (int r = 0; r < n; ++r) {
+          long long sum = 0;
+          for (int j = 0; j < n; ++j) {
+            sum += key[r][j] * hill.indexOf(text[start + j]);
+          }
+          expected[start + r] = hill.symbolAt(sum % m);
+        }
+      }
+      std::string encrypted = hill.encrypt(text);
+      /** @brief Шифрование совпадает с поблочным умножением на ключ */
+      CHECK_MESSAGE(encrypted == expected, "n = " << n << ", m = " << m);
+      /** @brief Расшифрование восстанавливает текст */
+      CHECK_MESSAGE(hill.decrypt(encrypted) == text,
+                    "n = " << n << ", m = " << m);
+    }
+  }
+}
+
+/**
+ * @brief Тестирование восстановления ключа Хилла по открытому тексту
+ * @details Первые блоки текста линейно зависимы (нулевой блок "aaa"), поэтому
+ *          ключ находится перебором других наборов блоков и должен совпасть
+ *          с исходным
+ */
+TEST_CASE("Testing Hill known-plaintext key recovery") {
+  std::vector<std::vector<int>> key = {{6, 24, 1}, {13, 16, 10}, {20, 17, 15}};
+  HillCipher hill3(key);
+  std::string open_text = "aaaaaaaaathequickbrownfoxjumpsoverthelazydog";
+  std::string shifr_text = hill3.encrypt(open_text);
+  /** @brief Проверка найденного ключа */
+  CHECK(recoverHillKey(hill3.decrypt(shifr_text), shifr_text, 3) == key);
+
+  /** @brief Слишком короткие тексты отвергаются */
+  CHECK_THROWS_AS(recoverHillKey("act", "poh", 3), std::invalid_argument);
+}
+
+/**
+ * @brief Тестирование атаки на шифр Хилла только по шифртексту
+ * @details Статистика языка собирается по одному английскому тексту, а
+ *          шифруется другой. Ключ 3x3 должен восстановиться построчным
+ *          перебором обратной матрицы
+ */
+TEST_CASE("Testing Hill ciphertext-only attack") {
+  QuadgramScorer scorer(
+      "It was the best of times, it was the worst of times, it was the age of "
+      "wisdom, it was the age of foolishness, it was the epoch of belief, it "
+      "was the epoch of incredulity, it was the season of Light, it was the "
+      "season of Darkness, it was the spring of hope, it was the winter of "
+      "despair, we had everything before us, we had nothing before us, we "
+      "were all going direct to Heaven, we were all going direct the other "
+      "way. In short, the period was so far like the present period, that "
+      "some of its noisiest authorities insisted on its being received, for "
+      "good or for evil, in the superlative degree of comparison only.",
+      "abcdefghijklmnopqrstuvwxyz");
+
+  std::vector<std::vector<int>> key = {{6, 24, 1}, {13, 16, 10}, {20, 17, 15}};
+  HillCipher hill3(key);
+  std::string shifr_text = hill3.encrypt(
+      "Call me Ishmael. Some years ago, never mind how long precisely, having "
+      "little or no money in my purse, and nothing particular to interest me "
+      "on shore, I thought I would sail about a little and see the watery "
+      "part of the world. It is a way I have of driving off the spleen and "
+      "regulating the circulation. Whenever I find myself growing grim about "
+      "the mouth; whenever it is a damp, drizzly November in my soul; then, I "
+      "account it high time to get to sea as soon as I can.");
+
+  HillAttackResult result = breakHillCiphertextOnly(shifr_text, 3, scorer);
+  /** @brief Проверка найденного ключа */
+  CHECK(result.key == key);
+  /** @brief Проверка начала расшифрованного текста */
+  CHECK(result.plaintext.substr(0, 13) == "callmeishmael");
+}
+
+/**
+ * @brief Тестирование потоковой обработки Хилла на месте
+ * @details Текст подаётся частями неудобной длины (блоки разрываются на
+ *          стыках), результат должен совпасть с шифрованием целиком; с
+ *          дополнением в стиле PKCS#7 расшифрование возвращает исходную длину
+ */
+TEST_CASE("Testing HillStream in-place processing") {
+  HillCipher hill3({{6, 24, 1}, {13, 16, 10}, {20, 17, 15}});
+  std::string open_text = "Attack at dawn, retreat at dusk!";
+  std::string prepared = open_text;
+  prepared.resize(hill3.normalizeInPlace(prepared));
+  /** @brief Подготовка оставляет только строчные буквы */
+  CHECK(prepared == "attackatdawnretreatatdusk");
+
+  auto run = [](HillStream &stream, std::string text) {
+    std::string output;
+    auto sink = [&](std::span<char> part) {
+      output.append(part.begin(), part.end());
+    };
+    for (size_t pos = 0; pos < text.size(); pos += 4) {
+      size_t len = std::min<size_t>(4, text.size() - pos);
+      stream.update(std::span<char>(text.data() + pos, len), sink);
+    }
+    stream.finish(sink);
+    return output;
+  };
+
+  HillStream plainStream(hill3, false);
+  /** @brief Потоковое шифрование совпадает с шифрованием целиком */
+  CHECK(run(plainStream, prepared) == hill3.encrypt(open_text));
+
+  HillStream encryptor(hill3, false, HillPadding::Length);
+  HillStream decryptor(hill3, true, HillPadding::Length);
+  std::string shifr_text = run(encryptor, prepared);
+  /** @brief Дополнение PKCS#7 занимает от 1 до n символов */
+  CHECK(shifr_text.size() == 27);
+  /** @brief Расшифрование снимает дополнение */
+  CHECK(run(decryptor, shifr_text) == prepared);
+
+  std::string inplace = "poh";
+  hill3.decryptInPlace(inplace);
+  /** @brief Расшифрование на месте */
+  CHECK(inplace == "act");
+}
+
+/**
+ * @brief Тестирование векторного XOR шифра Вернама
+ * @details Проверяем длинный текст (ключ разворачивается на участки) и
+ *          обработку с ненулевой фазой ключа: вторая половина, обработанная
+ *          отдельно со своим смещением, должна совпасть с общим результатом
+ */
+TEST_CASE("Testing VernamCipher buffer processing") {
+  VernamCipher vernam("secret");
+  std::string open_text;
+  for (int i = 0; i < 10000; ++i) {
+    open_text += static_cast<char>('a' + i % 26);
+  }
+  std::string shifr_text = vernam.encrypt(open_text);
+  /** @brief Проверка отдельного байта: позиция 26 - буква 'a' и фаза 2 ('c') */
+  CHECK(shifr_text[26] == static_cast<char>('a' ^ 'c'));
+
+  std::string tail = open_text.substr(4999);
+  vernam.processInPlace(tail, 4999);
+  /** @brief Проверка обработки со смещением */
+  CHECK(tail == shifr_text.substr(4999));
+  /** @brief Проверка полного цикла */
+  CHECK(vernam.decrypt(shifr_text) == open_text);
+}
+
+/**
+ * @brief Тестирование одноразового блокнота в файле
+ * @details Блокнот из 100 байт: два файла по 40 байт шифруются разными его
+ *          частями, на третий блокнота уже не хватает. Смещение сохраняется
+ *          между открытиями блокнота
+ */
+TEST_CASE("Testing VernamPad file mode") {
+  namespace fs = std::filesystem;
+  fs::path dir = uniqueTempPath("shifres_pad_test");
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  auto writeFile = [](const fs::path &path, const std::string &data) {
+    std::ofstream(path, std::ios::binary) << data;
+  };
+  auto readFile = [](const fs::path &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  };
+
+  std::string padBytes;
+  for (int i = 0; i < 100; ++i) {
+    padBytes += static_cast<char>(i * 37 + 11);
+  }
+  writeFile(dir / "pad", padBytes);
+  std::string open_text = "one-time pads must never be reused twice";
+  writeFile(dir / "open", open_text);
+
+  {
+    VernamPad pad((dir / "pad").string());
+    pad.encryptFile((dir / "open").string(), (dir / "first").string());
+    pad.encryptFile((dir / "open").string(), (dir / "second").string());
+    /** @brief Использовано 80 байт блокнота */
+    CHECK(pad.remaining() == 20);
+    /** @brief На третий файл блокнота не хватает */
+    CHECK_THROWS_AS(
+        pad.encryptFile((dir / "open").string(), (dir / "third").string()),
+        std::runtime_error);
+  }
+
+  VernamPad pad((dir / "pad").string());
+  /** @brief Смещение сохранилось после повторного открытия */
+  CHECK(pad.offset() == 80);
+  /** @brief Разные части блокнота дают разные шифртексты */
+  CHECK(readFile(dir / "first") != readFile(dir / "second"));
+  pad.decryptFile((dir / "second").string(), (dir / "back").string());
+  /** @brief Расшифрование восстанавливает исходный файл */
+  CHECK(readFile(dir / "back") == open_text);
+
+  /** @brief Вход и выход в одном файле отвергаются, блокнот не расходуется */
+  CHECK_THROWS_AS(pad.encryptFile((dir / "back").string(),
+                                  (dir / "." / "back").string()),
+                  std::runtime_error);
+  CHECK(pad.offset() == 80);
+  CHECK(readFile(dir / "back") == open_text);
+  CHECK_THROWS_AS(
+      pad.decryptFile((dir / "second").string(), (dir / "second").string()),
+      std::runtime_error);
+  CHECK(readFile(dir / "second").size() == open_text.size() + 8);
+  /** @brief Выход поверх блокнота тоже отвергается */
+  CHECK_THROWS_AS(
+      pad.decryptFile((dir / "second").string(), (dir / "pad").string()),
+      std::runtime_error);
+  CHECK(readFile(dir / "pad") == padBytes);
+
+  writeFile(dir / "other", padBytes);
+  writeFile(dir / "other.offset", "garbage\n");
+  /** @brief Повреждённый файл смещения - ошибка, блокировка снимается */
+  CHECK_THROWS_AS(VernamPad((dir / "other").string()), std::runtime_error);
+  writeFile(dir / "other.offset", "12\n");
+  CHECK(VernamPad((dir / "other").string()).offset() == 12);
+  fs::remove_all(dir);
+}
+
+/**
+ * @brief Тестирование шифра Вернама с гаммой ChaCha20
+ * @details Проверяем тестовый вектор RFC 8439 (раздел 2.4.2, счётчик 1 -
+ *          это смещение 64 в гамме) и независимость гаммы от места начала
+ *          обработки
+ */
+TEST_CASE("Testing VernamKeystream") {
+  std::string key;
+  for (int i = 0; i < 32; ++i) {
+    key += static_cast<char>(i);
+  }
+  VernamKeystream stream(key, std::string("\0\0\0\0\0\0\0\x4a\0\0\0\0", 12));
+  std::string open_text = "Ladies and Gentlemen of the class of '99: If I "
+                          "could offer you only one tip for the future, "
+                          "sunscreen would be it.";
+  std::string shifr_text(open_text.size(), '\0');
+  stream.process(open_text, shifr_text, 64);
+  /** @brief Проверка первых байт шифртекста из RFC 8439 */
+  CHECK(shifr_text.substr(0, 8) ==
+        std::string("\x6e\x2e\x35\x9a\x25\x68\xf9\x80", 8));
+  /** @brief Проверка последних байт шифртекста из RFC 8439 */
+  CHECK(shifr_text.substr(112) == std::string("\x87\x4d", 2));
+
+  std::string tail = open_text.substr(50);
+  stream.processInPlace(tail, 64 + 50);
+  /** @brief Гамма с середины совпадает с общей */
+  CHECK(tail == shifr_text.substr(50));
+
+  VernamKeystream seeded("short seed");
+  /** @brief Проверка полного цикла с коротким ключом */
+  CHECK(seeded.decrypt(seeded.encrypt(open_text)) == open_text);
+}
+
+/**
+ * @brief Тестирование восьмиблочного ядра ChaCha20
+ * @details Длинная гамма с ненулевого счётчика вычисляется по 8 блоков за
+ *          раз (при наличии AVX2); сравниваем её с тестовым вектором RFC 8439
+ *          (раздел 2.3.2, счётчик 1) и с гаммой, полученной по одному блоку
+ */
+TEST_CASE("Testing ChaCha20 wide kernel") {
+  unsigned char key[32];
+  for (int i = 0; i < 32; ++i) {
+    key[i] = static_cast<unsigned char>(i);
+  }
+  const unsigned char nonce[12] = {0, 0, 0, 9, 0, 0, 0, 0x4a, 0, 0, 0, 0};
+  ChaCha20 chacha(key, nonce);
+  std::string wide(2048 + 64, '\0');
+  chacha.keystream(64, reinterpret_cast<unsigned char *>(wide.data()),
+                   wide.size());
+  /** @brief Проверка первых байт блока 1 из RFC 8439 */
+  CHECK(wide.substr(0, 8) ==
+        std::string("\x10\xf1\xe7\xe4\xd1\x3b\x59\x15", 8));
+
+  std::string narrow(wide.size(), '\0');
+  for (size_t pos = 0; pos < narrow.size(); pos += 64) {
+    chacha.keystream(64 + pos,
+                     reinterpret_cast<unsigned char *>(narrow.data() + pos),
+                     64);
+  }
+  /** @brief Гамма по 8 блоков совпадает с поблочной */
+  CHECK(wide == narrow);
+}
+
+/**
+ * @brief Тестирование вскрытия VernamCipher с повторяющимся ключом
+ * @details Шифруем английский текст коротким ключом и восстанавливаем длину
+ *          ключа и сам ключ только по шифртексту
+ */
+TEST_CASE("Testing repeating-key XOR attack") {
+  std::string sentence = "It was the best of times, it was the worst of "
+                         "times, it was the age of wisdom, it was the age "
+                         "of foolishness, it was the epoch of belief. ";
+  std::string open_text;
+  while (open_text.size() < 20000) {
+    open_text += sentence;
+  }
+  VernamCipher vernam("Dickens1859");
+  std::string shifr_text = vernam.encrypt(open_text);
+
+  auto ranked = rankXorKeySizes(shifr_text, 40, 2);
+  /** @brief Наименьшая доля различающихся бит - у длины, кратной ключу */
+  CHECK(ranked.front().first % 11 == 0);
+  /** @brief Столбцы решаются при известной длине ключа */
+  CHECK(solveXorKey(shifr_text, 11, englishByteModel(), 3) == "Dickens1859");
+  /** @brief Полное вскрытие находит наименьшую длину и ключ */
+  CHECK(breakRepeatingXor(shifr_text, 40, 4) == "Dickens1859");
+  /** @brief Слишком короткий шифртекст или пустой диапазон длин ключа */
+  CHECK(rankXorKeySizes(std::string_view("abc"), 0).empty());
+  CHECK_THROWS_AS(breakRepeatingXor(std::string_view("a")),
+                  std::invalid_argument);
+  CHECK_THROWS_AS(breakRepeatingXor(shifr_text, 0), std::invalid_argument);
+}
+
+/**
+ * @brief Тестирование параллельной обработки шифром Вернама
+ * @details Буфер больше порога распараллеливания и некратной длины
+ *          обрабатывается пулом из нескольких потоков и сравнивается с
+ *          последовательной обработкой с тем же смещением
+ */
+TEST_CASE("Testing parallel Vernam processing") {
+  ThreadPool pool(4);
+  std::string open_text(3 * parallelXorMinSize + 12345, '\0');
+  for (size_t i = 0; i < open_text.size(); ++i) {
+    open_text[i] = static_cast<char>(i * 131 + i / 7);
+  }
+  std::string serial(open_text.size(), '\0');
+  std::string parallel(open_text.size(), '\0');
+
+  VernamCipher vernam("phase-key");
+  vernam.process(open_text, serial, 5);
+  vernam.processParallel(open_text, parallel, 5, pool);
+  /** @brief Фаза ключа каждого участка выбрана верно */
+  CHECK(parallel == serial);
+
+  VernamKeystream stream("seed", "nonce");
+  stream.process(open_text, serial, 70);
+  stream.processParallel(open_text, parallel, 70, pool);
+  /** @brief Гамма каждого участка вычислена со своего смещения */
+  CHECK(parallel == serial);
+
+  auto failing = [](unsigned part) {
+    if (part == 3) {
+      throw std::runtime_error("part");
+    }
+  };
+  /** @brief Исключение из потока пула передаётся вызывающему */
+  CHECK_THROWS_AS(pool.run(failing), std::runtime_error);
+}
+
+/**
+ * @brief Тестирование класса шифра Виженера
+ * @details Проверяем совпадение с main_Vij, обработку с середины потока,
+ *          параллельную обработку большого текста и ошибки параметров
+ */
+TEST_CASE("Testing VigenereCipher") {
+  std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+  VigenereCipher cipher(alphabet, "rus");
+  /** @brief Результат совпадает с main_Vij */
+  CHECK(cipher.encrypt("helloworld") == "yydciofldu");
+  CHECK(cipher.decrypt("yydciofldu") == "helloworld");
+
+  std::string part = "oworld";
+  cipher.encrypt(part, part, 4);
+  /** @brief Фаза ключа определяется смещением */
+  CHECK(part == "iofldu");
+
+  ThreadPool pool(3);
+  std::string open_text(2 * (size_t(1) << 20) + 777, 'a');
+  for (size_t i = 0; i < open_text.size(); ++i) {
+    open_text[i] = alphabet[(i * 7 + i / 5) % 26];
+  }
+  ThreadPool one(1);
+  std::string serial(open_text.size(), '\0');
+  cipher.encrypt(open_text, serial, 0, one);
+  std::string parallel(open_text.size(), '\0');
+  cipher.encrypt(open_text, parallel, 0, pool);
+  /** @brief Параллельное шифрование совпадает с последовательным */
+  CHECK(parallel == serial);
+  cipher.decrypt(parallel, parallel, 0, pool);
+  /** @brief Параллельное расшифрование на месте */
+  CHECK(parallel == open_text);
+
+  /** @brief Ключ из символов не из алфавита отвергается */
+  CHECK_THROWS_AS(VigenereCipher(alphabet, "Key"), std::invalid_argument);
+  /** @brief Символ текста не из алфавита отвергается */
+  CHECK_THROWS_AS(cipher.encrypt("hello world"), std::invalid_argument);
+  /** @brief Алфавит с повторами отвергается */
+  CHECK_THROWS_AS(VigenereCipher("abca", "b"), std::invalid_argument);
+
+  std::string wide;
+  for (int c = 32; c < 232; ++c) {
+    wide += static_cast<char>(c);
+  }
+  VigenereCipher large(wide, "Long key for a wide alphabet");
+  std::string sample = "Mixed CASE text, digits 0123 and symbols ~!@#";
+  /** @brief Алфавит больше таблицы Виженера обрабатывается сложением */
+  CHECK(large.decrypt(large.encrypt(sample)) == sample);
+}
+
+/**
+ * @brief Тестирование векторного шифра Виженера для непрерывных алфавитов
+ * @details Сравниваем с вычислением по определению для алфавита a-z и для
+ *          всех 256 байт, в том числе с несовпадающим с блоком смещением
+ */
+TEST_CASE("Testing VigenereCipher contiguous alphabets") {
+  std::string letters = "abcdefghijklmnopqrstuvwxyz";
+  std::string key = "lemonadeisgood";
+  VigenereCipher cipher(letters, key);
+  std::string open_text(10007, 'a');
+  for (size_t i = 0; i < open_text.size(); ++i) {
+    open_text[i] = letters[(i * 11 + i / 3) % 26];
+  }
+  std::string expected(open_text.size(), '\0');
+  for (size_t i = 0; i < open_text.size(); ++i) {
+    expected[i] = letters[(open_text[i] - 'a' + key[(i + 3) % key.size()] -
+                           'a') %
+                          26];
+  }
+  std::string shifr_text(open_text.size(), '\0');
+  cipher.encrypt(open_text, shifr_text, 3);
+  /** @brief Векторное шифрование совпадает с определением */
+  CHECK(shifr_text == expected);
+  cipher.decrypt(shifr_text, shifr_text, 3);
+  /** @brief Векторное расшифрование восстанавливает текст */
+  CHECK(shifr_text == open_text);
+
+  open_text[9000] = '!';
+  /** @brief Символ вне алфавита в середине буфера обнаруживается */
+  CHECK_THROWS_AS(cipher.encrypt(open_text), std::invalid_argument);
+
+  std::string bytes;
+  for (int c = 0; c < 256; ++c) {
+    bytes += static_cast<char>(c);
+  }
+  VigenereCipher binary(bytes, std::string("\x00\xff\x80\x01", 4));
+  std::string data(5000, '\0');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i * 37);
+  }
+  std::string shifted = binary.encrypt(data);
+  /** @brief Алфавит из всех байт - сложение по модулю 256 */
+  CHECK(static_cast<unsigned char>(shifted[4001]) ==
+        static_cast<unsigned char>(data[4001] + 0xff));
+  CHECK(binary.decrypt(shifted) == data);
+}
+
+/**
+ * @brief Тестирование вскрытия шифра Виженера
+ * @details Шифруем английский текст из случайно выбранных слов и находим
+ *          длину ключа и ключ только по шифртексту
+ */
+TEST_CASE("Testing Vigenere cryptanalysis") {
+  std::vector<std::string> words = {
+      "the",   "of",     "and",  "to",    "in",    "is",    "that",
+      "for",   "it",     "was",  "on",    "with",  "he",    "as",
+      "by",    "at",     "from", "his",   "they",  "this",  "have",
+      "which", "one",    "you",  "were",  "her",   "all",   "she",
+      "there", "would",  "their", "will", "when",  "who",   "make",
+      "time",  "people", "year", "good",  "world", "school", "state"};
+  std::string open_text;
+  unsigned seed = 7;
+  while (open_text.size() < 6000) {
+    seed = seed * 1103515245 + 12345;
+    open_text += words[(seed >> 16) % words.size()];
+  }
+  std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+  VigenereCipher cipher(alphabet, "crypto");
+  std::string shifr_text = cipher.encrypt(open_text);
+
+  ThreadPool pool(3);
+  auto periods = rankVigenerePeriods(vigenereIndices(shifr_text, alphabet),
+                                     alphabet.size(), 40, pool);
+  /** @brief Наиболее вероятная длина ключа - 6 */
+  CHECK(periods.front().period == 6);
+
+  auto keys = breakVigenere(shifr_text, alphabet, englishLetterFrequencies(),
+                            40, 3, pool);
+  /** @brief Лучший кандидат - исходный ключ */
+  CHECK(keys.front().key == "crypto");
+}
+
+/**
+ * @brief Тестирование перебора ключей Виженера по словарю
+ * @details Словарь из случайных строк содержит ключ; он должен оказаться
+ *          лучшим кандидатом, а слова с символами вне алфавита пропускаются
+ */
+TEST_CASE("Testing Vigenere dictionary search") {
+  namespace fs = std::filesystem;
+  fs::path path = uniqueTempPath("shifres_wordlist_test");
+  std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+  std::string wordlist = "Lighthouse\r\nlight-house\n";
+  unsigned seed = 3;
+  for (int i = 0; i < 50000; ++i) {
+    if (i == 31337) {
+      wordlist += "lighthouse\r\n";
+    }
+    for (int j = 0; j < 4 + i % 8; ++j) {
+      seed = seed * 1103515245 + 12345;
+      wordlist += alphabet[(seed >> 16) % 26];
+    }
+    wordlist += '\n';
+  }
+  std::ofstream(path, std::ios::binary) << wordlist;
+
+  std::string open_text;
+  for (int i = 0; i < 40; ++i) {
+    open_text += "shipsmustkeepclearoftherocksatnight";
+  }
+  VigenereCipher cipher(alphabet, "lighthouse");
+  std::string shifr_text = cipher.encrypt(open_text);
+
+  ThreadPool pool(4);
+  auto matches = searchVigenereDictionaryFile(
+      shifr_text, path.string(), alphabet, englishLetterFrequencies(), 3,
+      pool);
+  /** @brief Ключ из словаря найден и стоит первым */
+  REQUIRE(!matches.empty());
+  CHECK(matches.front().key == "lighthouse");
+  fs::remove(path);
+
+  std::string repeated;
+  for (int i = 0; i < 100; ++i) {
+    repeated += "lighthouse\n";
+  }
+  repeated += "lighthouselighthouselighthouse\nlighthouselighthouse\n";
+  matches = searchVigenereDictionary(shifr_text, repeated, alphabet,
+                                     englishLetterFrequencies(), 3, pool);
+  /** @brief Повторы слова занимают одно место, равные оценки - по ключу */
+  REQUIRE(matches.size() == 3);
+  CHECK(matches[0].key == "lighthouse");
+  CHECK(matches[1].key == "lighthouselighthouse");
+  CHECK(matches[2].key == "lighthouselighthouselighthouse");
+}
+
+/**
+ * @brief Тестирование шифра Виженера с самоключом
+ * @details Проверяем классический пример (ключ "queenly"), обработку
+ *          потока частями произвольной длины и через потоки ввода-вывода
+ */
+TEST_CASE("Testing VigenereAutokey") {
+  VigenereCipher cipher("abcdefghijklmnopqrstuvwxyz", "queenly");
+  VigenereAutokey encryptor(cipher, false);
+  std::string open_text = "attackatdawn";
+  std::string shifr_text(open_text.size(), '\0');
+  encryptor.update(open_text, shifr_text);
+  /** @brief Гамма продолжается открытым текстом */
+  CHECK(shifr_text == "qnxepvytwtwp");
+
+  std::string long_text;
+  for (int i = 0; i < 1000; ++i) {
+    long_text += "thequickbrownfox"[i % 16];
+  }
+  encryptor.reset();
+  std::string whole(long_text.size(), '\0');
+  encryptor.update(long_text, whole);
+
+  VigenereAutokey decryptor(cipher, true);
+  std::string parts = whole;
+  for (size_t pos = 0, len = 1; pos < parts.size(); pos += len, len += 3) {
+    len = std::min(len, parts.size() - pos);
+    std::span<char> chunk(parts.data() + pos, len);
+    decryptor.update(chunk, chunk);
+  }
+  /** @brief Расшифрование частями восстанавливает текст */
+  CHECK(parts == long_text);
+
+  std::istringstream in(long_text);
+  std::ostringstream out;
+  encryptor.reset();
+  encryptor.process(in, out);
+  /** @brief Обработка потока совпадает с обработкой целиком */
+  CHECK(out.str() == whole);
+}
+
+/**
+ * @brief Запуск CLI с заданными параметрами и входом
+ * @param args Аргументы командной строки без имени программы
+ * @param input Вход
+ * @param output Выход программы
+ * @return Код завершения
+ */
+static int runCliWith(std::vector<const char *> args, const std::string &input,
+                      std::string &output) {
+  args.insert(args.begin(), "shifres");
+  std::istringstream in(input);
+  std::ostringstream out, err;
+  int code = runCli(args.size(), args.data(), in, out, err);
+  output = out.str();
+  return code;
+}
+
+/**
+ * @brief Тестирование неинтерактивного запуска шифров
+ * @details Проверяем, что результат совпадает с классами шифров, что
+ *          выводится только результат и что ошибки в параметрах дают код 2
+ */
+TEST_CASE("Testing batch CLI") {
+  std::string output;
+  /** @brief Виженер: символы вне алфавита не сдвигают ключ */
+  CHECK(runCliWith({"-c", "vigenere", "-k", "rus"}, "hello world\n",
+                   output) == 0);
+  CHECK(output == "yydci ofldu\n");
+  std::string plain;
+  CHECK(runCliWith({"--cipher", "vigenere", "--key", "rus", "--decrypt"},
+                   output, plain) == 0);
+  CHECK(plain == "hello world\n");
+
+  /** @brief Аффинный шифр: шифрование и расшифрование */
+  CHECK(runCliWith({"-c", "affine", "-k", "5 8"}, "attack", output) == 0);
+  CHECK(output == AffineCipher("abcdefghijklmnopqrstuvwxyz", 5, 8)
+                      .encrypt(std::string("attack")));
+  CHECK(runCliWith({"-c", "affine", "-k", "5 8", "-d"}, output, plain) == 0);
+  CHECK(plain == "attack");
+
+  /** @brief RSA: числа через пробельные символы, результаты по строкам */
+  CHECK(runCliWith({"-c", "rsa", "-k", "61 53 17"}, "65 123", output) == 0);
+  CHECK(output == "2790\n855\n");
+  /** @brief Составное число в ключе RSA - ошибка выполнения */
+  CHECK(runCliWith({"-c", "rsa", "-k", "61 55 17"}, "65", output) == 1);
+
+  /** @brief Ошибки в параметрах */
+  CHECK(runCliWith({"-c", "unknown", "-k", "x"}, "", output) == 2);
+  CHECK(runCliWith({"-c", "vernam"}, "", output) == 2);
+  /** @brief Некорректный ключ */
+  CHECK(runCliWith({"-c", "affine", "-k", "2 3"}, "", output) == 1);
+  /** @brief Числа ключа вне int не усекаются молча */
+  CHECK(runCliWith({"-c", "affine", "-k", "4294967299 0"}, "abc", output) ==
+        2);
+  CHECK(runCliWith({"-c", "hill", "-k", "3 3 2 -4294967291"}, "ab", output) ==
+        2);
+}
+
+/**
+ * @brief Тестирование режима фильтра
+ * @details Текст длиннее нескольких циклов writev шифруется через файловые
+ *          дескрипторы; результат должен совпадать с runCli
+ */
+TEST_CASE("Testing filter mode") {
+  namespace fs = std::filesystem;
+  fs::path dir = uniqueTempPath("shifres_filter_test");
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  std::string input = (dir / "in").string(), output = (dir / "out").string();
+  std::string text;
+  for (int i = 0; i < 200000; ++i) {
+    text += "the quick brown fox\n"[i % 20];
+    text += static_cast<char>('a' + i * 7 % 26);
+  }
+  std::ofstream(input, std::ios::binary) << text;
+  auto readFile = [](const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  };
+
+  std::vector<std::vector<const char *>> runs = {
+      {"-c", "vigenere", "-k", "lemon"},
+      {"-c", "subst", "-k", "qwertyuiopasdfghjklzxcvbnm", "-d"},
+      {"-c", "affine", "-k", "5 8"},
+      {"-c", "vernam", "-k", "secret"}};
+  for (std::vector<const char *> args : runs) {
+    std::string expected;
+    REQUIRE(runCliWith(args, text, expected) == 0);
+    args.insert(args.begin(), "shifres");
+    args.insert(args.end(), {"-i", input.c_str(), "-o", output.c_str()});
+    std::ostringstream err;
+    /** @brief Фильтр выдаёт тот же результат, что и runCli */
+    CHECK(runCliFilter(args.size(), args.data(), -1, -1, err) == 0);
+    CHECK(readFile(output) == expected);
+  }
+
+  std::vector<const char *> rsa = {"shifres", "-c", "rsa", "-k", "61 53 17"};
+  std::ostringstream err;
+  /** @brief RSA и Хилл не работают в режиме фильтра */
+  CHECK_FALSE(isCliFilter(rsa.size(), rsa.data()));
+  CHECK(runCliFilter(rsa.size(), rsa.data(), -1, -1, err) == 1);
+  fs::remove_all(dir);
+}
+
+/**
+ * @brief Тестирование сервера шифрования
+ * @details Сервер на временном сокете обслуживает два клиента; результаты
+ *          совпадают с классами шифров, ошибки возвращаются клиенту, а
+ *          соединение после ошибки продолжает работать
+ */
+TEST_CASE("Testing encryption daemon") {
+  std::string path = uniqueTempPath("shifres_daemon_test", ".sock").string();
+  DaemonKeyStore keys;
+  keys.add(1, "rus");
+  keys.add(2, "5 8");
+  keys.add(3, "61 53 17");
+  DaemonServer server(path, keys, 2);
+  std::thread loop([&] { server.run(); });
+
+  DaemonClient client(path), other(path);
+  /** @brief Виженер через сервер совпадает с VigenereCipher */
+  CHECK(client.call(DaemonCipher::Vigenere, 1, DaemonMode::Encrypt,
+                    "hello world") == "yydci ofldu");
+  CHECK(other.call(DaemonCipher::Vigenere, 1, DaemonMode::Decrypt,
+                   "yydci ofldu") == "hello world");
+  /** @brief Один номер ключа для разных шифров */
+  CHECK(client.call(DaemonCipher::Rsa, 3, DaemonMode::Encrypt, "65") ==
+        "2790\n");
+  std::string big(3 << 20, 'q');
+  std::string shifr = other.call(DaemonCipher::Affine, 2, DaemonMode::Encrypt,
+                                 big);
+  /** @brief Большие запросы */
+  CHECK(other.call(DaemonCipher::Affine, 2, DaemonMode::Decrypt, shifr) ==
+        big);
+  /** @brief Неизвестный ключ и неподходящий ключ */
+  CHECK_THROWS_AS(client.call(DaemonCipher::Vigenere, 9, DaemonMode::Encrypt,
+                              "abc"),
+                  std::runtime_error);
+  CHECK_THROWS_AS(client.call(DaemonCipher::Affine, 1, DaemonMode::Encrypt,
+                              "abc"),
+                  std::runtime_error);
+  CHECK(client.call(DaemonCipher::Vigenere, 1, DaemonMode::Encrypt, "") ==
+        "");
+
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  int raw = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  REQUIRE(connect(raw, reinterpret_cast<sockaddr *>(&address),
+                  sizeof(address)) == 0);
+  char header[daemonRequestHeader] = {};
+  header[0] = static_cast<char>(DaemonCipher::Vigenere);
+  header[1] = static_cast<char>(DaemonMode::Encrypt);
+  putDaemonU32(header + 4, 1);
+  std::string requests(daemonRequestHeader + big.size(), 'h');
+  putDaemonU32(header + 8, big.size());
+  std::memcpy(requests.data(), header, sizeof(header));
+  putDaemonU32(header + 8, 5);
+  requests += std::string(header, sizeof(header)) + "world";
+  iovec part = {requests.data(), requests.size()};
+  writeAll(raw, std::span<iovec>(&part, 1));
+  shutdown(raw, SHUT_WR);
+  std::string replies;
+  char buffer[65536];
+  for (size_t got; (got = readSome(raw, buffer, sizeof(buffer))) > 0;) {
+    replies.append(buffer, got);
+  }
+  close(raw);
+  /** @brief Запросы, принятые вместе с концом входа, получают ответы */
+  REQUIRE(replies.size() == 2 * daemonResponseHeader + big.size() + 5);
+  CHECK(getDaemonU32(replies.data() + 4) == big.size());
+  CHECK(replies.substr(replies.size() - 5) == "nijcx");
+
+  server.stop();
+  loop.join();
+
+  std::string keysPath = uniqueTempPath("shifres_daemon_keys").string();
+  auto loadKeys = [&](const std::string &text) {
+    std::ofstream(keysPath) << text;
+    DaemonKeyStore store;
+    store.load(keysPath);
+    return store;
+  };
+  /** @brief Номер ключа с лишними символами или вне uint32 отвергается */
+  CHECK_THROWS_AS(loadKeys("12x\trus\n"), std::runtime_error);
+  CHECK_THROWS_AS(loadKeys("# ключи\n4294967297\trus\n"),
+                  std::runtime_error);
+  CHECK(loadKeys("4294967295\trus\n")
+            .context(static_cast<uint8_t>(DaemonCipher::Vigenere),
+                     4294967295u) != nullptr);
+  std::filesystem::remove(keysPath);
+}
+
+/**
+ * @brief Тестирование кэша подготовленных контекстов
+ * @details Повторный запрос ключа не вызывает подготовку, давно не
+ *          использованный ключ вытесняется, ошибки подготовки не кэшируются,
+ *          а из разных потоков возвращается один и тот же объект
+ */
+TEST_CASE("Testing context cache") {
+  LruCache<std::string> cache(2, 1);
+  int made = 0;
+  auto make = [&](const char *value) {
+    return [&made, value] {
+      ++made;
+      return std::make_shared<const std::string>(value);
+    };
+  };
+  auto first = cache.get("a", make("A"));
+  /** @brief Попадание возвращает тот же объект без подготовки */
+  CHECK(cache.get("a", make("X")) == first);
+  CHECK(made == 1);
+  cache.get("b", make("B"));
+  cache.get("a", make("X"));
+  cache.get("c", make("C"));
+  /** @brief Вытесняется давно не использованный ключ b, а не a */
+  CHECK(cache.size() == 2);
+  CHECK(*cache.get("a", make("X")) == "A");
+  CHECK(*cache.get("b", make("B2")) == "B2");
+  CHECK(cache.hits() == 3);
+  CHECK(cache.misses() == 4);
+
+  size_t cached = preparedContexts<AffineCipher>().size();
+  /** @brief Ошибка подготовки не остаётся в кэше */
+  CHECK_THROWS_AS(cachedContext<AffineCipher>({"affine", "abcd", "2", "1"},
+                                              std::string("abcd"), 2, 1),
+                  std::invalid_argument);
+  CHECK(preparedContexts<AffineCipher>().size() == cached);
+
+  CliOptions options;
+  options.cipher = "vigenere";
+  options.key = "rus";
+  std::vector<std::shared_ptr<const CliContext>> seen(4);
+  ThreadPool pool(4);
+  pool.run([&](unsigned part) { seen[part] = CliContext::cached(options); });
+  /** @brief Все потоки получают один контекст */
+  CHECK(std::count(seen.begin(), seen.end(), seen[0]) == 4);
+  CHECK(CliContext::cached(options) == seen[0]);
+}
+
+/**
+ * @brief Тестирование общего интерфейса шифров
+ * @details Статический вызов через CipherBase и виртуальный через Cipher дают
+ *          те же результаты, что и методы каждого шифра; буферы обрабатываются
+ *          с произвольного смещения и параллельно
+ */
+TEST_CASE("Testing unified cipher interface") {
+  AffineCipher affine("abcdefghijklmnopqrstuvwxyz", 5, 8);
+  std::string text = "attack at dawn";
+  std::string out(text.size(), '\0');
+  /** @brief Статический вызов совпадает с методами шифра */
+  CHECK(affine.transform(text, out, Direction::Encrypt) == text.size());
+  CHECK(out == affine.encrypt(text));
+  CHECK(affine.transform(out, Direction::Decrypt) == text);
+  /** @brief Выходной буфер меньше входа */
+  CHECK_THROWS_AS(affine.transform(text, std::span<char>(out).first(3),
+                                   Direction::Encrypt),
+                  std::invalid_argument);
+
+  VigenereCipher vigenere("abcdefghijklmnopqrstuvwxyz", "lemon");
+  std::string letters = "attackatdawn";
+  std::string tail = letters.substr(5);
+  vigenere.transformInPlace(tail, Direction::Encrypt, 5);
+  /** @brief Смещение продолжает фазу ключа */
+  CHECK(tail == vigenere.encrypt(letters).substr(5));
+
+  HillCipher hill({{3, 3}, {2, 5}});
+  /** @brief Шифр Хилла меняет длину: текст подготавливается и дополняется */
+  CHECK(hill.maxOutput(5, Direction::Encrypt) == 6);
+  CHECK(hill.transform("Act!s", Direction::Encrypt) == hill.encrypt("acts"));
+
+  RsaKey rsa(17, 19, 5);
+  /** @brief RSA через общий интерфейс обрабатывает десятичные числа */
+  CHECK(rsa.transform("2 100\n", Direction::Encrypt) ==
+        std::to_string(rsa.encrypt(2)) + "\n" +
+            std::to_string(rsa.encrypt(100)) + "\n");
+  CHECK_THROWS_AS(rsa.transform("323", Direction::Encrypt),
+                  std::invalid_argument);
+
+  CliOptions options;
+  const char *names[] = {"affine", "vigenere", "subst", "vernam", "hill",
+                         "rsa"};
+  const char *keys[] = {"5 8", "lemon", "qwertyuiopasdfghjklzxcvbnm",
+                        "secret", "3 3 2 5", "17 19 5"};
+  for (size_t i = 0; i < 6; ++i) {
+    options.cipher = names[i];
+    options.key = keys[i];
+    CliContext context(options);
+    const Cipher &cipher = context.cipher();
+    std::string input = i == 5 ? "42 7" : "attackatdawn";
+    std::string encrypted = cipher.transform(input, Direction::Encrypt);
+    /** @brief Виртуальный вызов расшифровывает результат шифрования */
+    CHECK(cipher.transform(encrypted, Direction::Decrypt) ==
+          (i == 5 ? "42\n7\n" : input));
+    /** @brief Параллельная обработка только для шифров без смены длины */
+    CHECK(cipher.preservesLength() == (i < 4));
+  }
+
+  auto vernam = std::make_shared<const VernamCipher>("key");
+  CipherAdapter<VernamCipher> dynamic(vernam);
+  std::string large(2 * cipherParallelMinSize + 123, '\0');
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<char>(i * 31 + 7);
+  }
+  std::string parallel(large.size(), '\0');
+  ThreadPool pool(4);
+  dynamic.transformParallel(large, parallel, Direction::Encrypt, 1, pool);
+  std::string sequential(large.size(), '\0');
+  vernam->transform(large, sequential, Direction::Encrypt, 1);
+  /** @brief Параллельный результат совпадает с последовательным */
+  CHECK(parallel == sequential);
+  CipherAdapter<HillCipher> blocks(std::make_shared<const HillCipher>(hill));
+  CHECK_THROWS_AS(
+      blocks.transformParallel(text, out, Direction::Encrypt, 0, pool),
+      std::invalid_argument);
+}
+
+/**
+ * @brief Тестирование цепочки шифров
+ * @details Побайтовые замены сливаются в одну таблицу, а результат цепочки
+ *          совпадает с последовательным применением шифров при любом
+ *          смещении, разбиении и параллельной обработке
+ */
+TEST_CASE("Testing cipher pipeline") {
+  std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+  auto subst =
+      std::make_shared<const SimpleSubstitution>("qwertyuiopasdfghjklzxcvbnm");
+  auto affine = std::make_shared<const AffineCipher>(alphabet, 5, 8);
+  auto vigenere = std::make_shared<const VigenereCipher>(alphabet, "lemon");
+  auto vernam = std::make_shared<const VernamCipher>("secret");
+
+  CipherPipeline tables;
+  tables.add(subst).add(affine).add(subst, Direction::Decrypt);
+  std::string text = "thequickbrownfoxjumpsoverthelazydog";
+  /** @brief Три побайтовые замены - одна таблица */
+  CHECK(tables.stepCount() == 1);
+  CHECK(tables.transform(text, Direction::Encrypt) ==
+        subst->decrypt(affine->encrypt(subst->encrypt(text))));
+  CHECK(tables.transform(tables.transform(text, Direction::Encrypt),
+                         Direction::Decrypt) == text);
+
+  CipherPipeline layered;
+  layered.add(subst).add(affine).add(vigenere).add(vernam);
+  /** @brief Замены сливаются, ступени с позицией остаются */
+  CHECK(layered.stepCount() == 3);
+
+  std::string large(3 * pipelineTileSize + 777, 'a');
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = alphabet[(i * 7 + i / 13) % 26];
+  }
+  std::string expected =
+      vigenere->encrypt(affine->encrypt(subst->encrypt(large)));
+  vernam->processInPlace(expected);
+  std::string encrypted = layered.transform(large, Direction::Encrypt);
+  /** @brief Один проход совпадает с последовательным применением */
+  CHECK(encrypted == expected);
+  CHECK(layered.transform(encrypted, Direction::Decrypt) == large);
+
+  std::string tail = large.substr(pipelineTileSize + 5);
+  layered.transformInPlace(tail, Direction::Encrypt, pipelineTileSize + 5);
+  /** @brief Обработка с середины потока продолжает фазы ключей */
+  CHECK(tail == expected.substr(pipelineTileSize + 5));
+
+  std::string huge(cipherParallelMinSize + 4321, 'a');
+  for (size_t i = 0; i < huge.size(); ++i) {
+    huge[i] = alphabet[(i * 11 + i / 29) % 26];
+  }
+  std::string parallel(huge.size(), '\0');
+  ThreadPool pool(4);
+  layered.transformParallel(huge, parallel, Direction::Encrypt, 0, pool);
+  /** @brief Параллельная обработка совпадает с последовательной */
+  CHECK(parallel == layered.transform(huge, Direction::Encrypt));
+
+  /** @brief Ошибка ступени передаётся вызывающему */
+  CHECK_THROWS_AS(layered.transform("not letters!", Direction::Encrypt),
+                  std::invalid_argument);
+}